@@ -0,0 +1,120 @@
+/*
+ * MappedFile class implementation.
+ *
+ * Read-only memory mapping of files and the ROS_HOME directory they are cached in.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+
+namespace rviz
+{
+
+MappedFile::MappedFile()
+  : data_( NULL )
+  , size_( 0 )
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+bool MappedFile::open( const std::string& path )
+{
+  close();
+
+  int fd = ::open( path.c_str(), O_RDONLY );
+  if( fd < 0 )
+    return false;
+
+  struct stat info;
+  if( fstat( fd, &info ) != 0 || info.st_size <= 0 )
+  {
+    ::close( fd );
+    return false;
+  }
+
+  void* data = mmap( NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+  // the mapping keeps its own reference to the file
+  ::close( fd );
+  if( data == MAP_FAILED )
+    return false;
+
+  // files are parsed front to back, let the kernel read ahead aggressively
+  madvise( data, info.st_size, MADV_SEQUENTIAL );
+
+  data_ = static_cast<const unsigned char*>( data );
+  size_ = info.st_size;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if( data_ != NULL )
+    munmap( const_cast<unsigned char*>( data_ ), size_ );
+  data_ = NULL;
+  size_ = 0;
+}
+
+std::string getRosHomeDirectory()
+{
+  const char* ros_home = getenv( "ROS_HOME" );
+  if( ros_home != NULL && ros_home[0] != '\0' )
+    return ros_home;
+  const char* home = getenv( "HOME" );
+  if( home != NULL && home[0] != '\0' )
+    return std::string( home ) + "/.ros";
+  return std::string();
+}
+
+bool makeDirectories( const std::string& path )
+{
+  for( size_t slash = path.find( '/', 1 ); slash != std::string::npos; slash = path.find( '/', slash + 1 ))
+    mkdir( path.substr( 0, slash ).c_str(), 0755 );
+  if( mkdir( path.c_str(), 0755 ) == 0 || errno == EEXIST )
+    return true;
+  return false;
+}
+
+} // namespace rviz
@@ -0,0 +1,83 @@
+/*
+ * MappedFile declaration.
+ *
+ * Read-only memory mapping of files and the ROS_HOME directory they are cached in.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_MAPPED_FILE_H
+#define RVIZ_MAPPED_FILE_H
+
+#include <boost/noncopyable.hpp>
+
+#include <string>
+
+namespace rviz
+{
+
+/**
+ * \class MappedFile
+ * \brief Maps a whole file read-only into memory and unmaps it on destruction.
+ *
+ * Pages are read by the kernel as they are touched, so large files are parsed without being copied
+ * into a buffer first.
+ */
+class MappedFile : boost::noncopyable
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  // returns false and leaves the file closed if it cannot be opened or mapped
+  bool open( const std::string& path );
+  void close();
+
+  const unsigned char* getData() const { return data_; }
+  size_t getSize() const { return size_; }
+
+private:
+  const unsigned char* data_;
+  size_t size_;
+};
+
+// $ROS_HOME, falling back to ~/.ros; empty if neither is known
+std::string getRosHomeDirectory();
+
+// creates path and its missing parents, returns false if it does not exist afterwards
+bool makeDirectories( const std::string& path );
+
+} // namespace rviz
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * ParallelPool class implementation.
+ *
+ * Worker threads shared by all parallelFor loops of the process.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "parallel_for.h"
+
+namespace rviz
+{
+
+ParallelPool& ParallelPool::getInstance()
+{
+  static ParallelPool pool;
+  return pool;
+}
+
+ParallelPool::ParallelPool()
+  : running_( true )
+{
+  // the thread calling run() takes tasks too
+  size_t cores = std::max( boost::thread::hardware_concurrency(), 1u );
+  for( size_t i = 1; i < cores; i++ )
+    threads_.create_thread( boost::bind( &ParallelPool::work, this ));
+}
+
+ParallelPool::~ParallelPool()
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    running_ = false;
+  }
+  work_condition_.notify_all();
+  threads_.join_all();
+}
+
+void ParallelPool::run( const Task& task, size_t count )
+{
+  if( count == 0 )
+    return;
+
+  Loop loop;
+  loop.task = &task;
+  loop.count = count;
+  loop.next = 0;
+  loop.done = 0;
+  loop.failed = false;
+
+  boost::mutex::scoped_lock lock( mutex_ );
+  loops_.push_back( &loop );
+  work_condition_.notify_all();
+
+  while( loop.next < loop.count )
+    runNext( loop, lock );
+  while( loop.done < loop.count )
+    done_condition_.wait( lock );
+
+  if( loop.failed )
+    throw std::runtime_error( loop.error );
+}
+
+void ParallelPool::work()
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  while( true )
+  {
+    while( running_ && loops_.empty() )
+      work_condition_.wait( lock );
+    if( !running_ )
+      return;
+
+    runNext( *loops_.front(), lock );
+  }
+}
+
+void ParallelPool::runNext( Loop& loop, boost::mutex::scoped_lock& lock )
+{
+  size_t index = loop.next++;
+  if( loop.next == loop.count )
+    loops_.erase( std::find( loops_.begin(), loops_.end(), &loop ));
+
+  // a task must not unwind past the loop, the other threads still use it
+  std::string error;
+  bool failed = false;
+  lock.unlock();
+  try
+  {
+    (*loop.task)( index );
+  }
+  catch( const std::exception& e )
+  {
+    error = e.what();
+    failed = true;
+  }
+  catch( ... )
+  {
+    error = "unknown exception";
+    failed = true;
+  }
+  lock.lock();
+
+  if( failed && !loop.failed )
+  {
+    loop.error = error;
+    loop.failed = true;
+  }
+
+  // the caller returns once this is set, loop is gone afterwards
+  if( ++loop.done == loop.count )
+    done_condition_.notify_all();
+}
+
+} // namespace rviz
@@ -0,0 +1,148 @@
+/*
+ * Parallel loop helper.
+ *
+ * Splits per-element loops, such as building meshes and converting maps, over all cores.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_PARALLEL_FOR_H
+#define RVIZ_PARALLEL_FOR_H
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <stdint.h>
+
+namespace rviz
+{
+
+// number of ranges worth splitting count elements into: one per core, but at least min_range
+// elements each so that small inputs do not pay for waking threads
+inline size_t getParallelRangeCount( size_t count, size_t min_range )
+{
+  size_t cores = std::max( boost::thread::hardware_concurrency(), 1u );
+  size_t ranges = min_range > 0 ? count / min_range : count;
+  return std::max<size_t>( std::min( ranges, cores ), 1 );
+}
+
+inline size_t getParallelRangeBegin( size_t count, size_t num_ranges, size_t range )
+{
+  return (size_t)(( (uint64_t)count * range ) / num_ranges );
+}
+
+/**
+ * \class ParallelPool
+ * \brief Worker threads shared by every parallelFor() of the process.
+ *
+ * The threads are started on first use and kept, so a loop only pays for waking them. Several
+ * threads may run loops at the same time, also from inside a loop: the caller works through the
+ * tasks of its own loop as well, so every loop finishes even while the workers are busy elsewhere.
+ */
+class ParallelPool : boost::noncopyable
+{
+public:
+  typedef boost::function<void ( size_t )> Task;
+
+  static ParallelPool& getInstance();
+
+  // calls task( i ) for every i in [0, count) and returns when all of them are done; if a task
+  // throws, the others still finish and run() then throws a std::runtime_error with its message
+  void run( const Task& task, size_t count );
+
+private:
+  struct Loop
+  {
+    const Task* task;
+    size_t count;
+    size_t next;
+    size_t done;
+    // message of the first exception a task threw
+    std::string error;
+    bool failed;
+  };
+
+  ParallelPool();
+  ~ParallelPool();
+
+  void work();
+
+  // claims the next task of loop and runs it; must be called with mutex_ held, returns with it held
+  void runNext( Loop& loop, boost::mutex::scoped_lock& lock );
+
+  boost::thread_group threads_;
+  boost::mutex mutex_;
+  boost::condition_variable work_condition_;
+  boost::condition_variable done_condition_;
+
+  // loops that still have unclaimed tasks, oldest first
+  std::deque<Loop*> loops_;
+  bool running_;
+};
+
+template<class Function>
+void callParallelRange( const Function& function, size_t count, size_t num_ranges, size_t range )
+{
+  function( range, getParallelRangeBegin( count, num_ranges, range ), getParallelRangeBegin( count, num_ranges, range + 1 ));
+}
+
+/*
+ * Calls function( range, begin, end ) for num_ranges contiguous ranges covering [0, count) and
+ * returns when all of them are done. The ranges run on the ParallelPool and the calling thread;
+ * they are numbered so functions can keep per-range partial results.
+ */
+template<class Function>
+void parallelFor( size_t count, size_t num_ranges, Function function )
+{
+  if( num_ranges <= 1 )
+  {
+    function( 0, 0, count );
+    return;
+  }
+
+  ParallelPool::getInstance().run( boost::bind<void>( &callParallelRange<Function>, boost::cref( function ), count, num_ranges, _1 ),
+                                   num_ranges );
+}
+
+} // namespace rviz
+
+#endif
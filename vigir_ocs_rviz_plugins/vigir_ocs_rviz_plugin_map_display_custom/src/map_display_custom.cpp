@@ -29,6 +29,10 @@
 
 #include <boost/bind.hpp>
 
+#include <ctype.h>
+#include <stdio.h>
+#include <unistd.h>
+
 #include <OGRE/OgreManualObject.h>
 #include <OGRE/OgreMaterialManager.h>
 #include <OGRE/OgreSceneManager.h>
@@ -36,11 +40,15 @@
 #include <OGRE/OgreTextureManager.h>
 
 #include <ros/ros.h>
+#include <ros/serialization.h>
+
+#include <OGRE/OgreHardwarePixelBuffer.h>
 
 #include <tf/transform_listener.h>
 
 #include "rviz/frame_manager.h"
 #include "rviz/ogre_helpers/grid.h"
+#include "rviz/properties/enum_property.h"
 #include "rviz/properties/float_property.h"
 #include "rviz/properties/int_property.h"
 #include "rviz/properties/property.h"
@@ -51,14 +59,33 @@
 #include "rviz/display_context.h"
 
 #include "map_display_custom.h"
+#include "mapped_file.h"
+#include "occupancy_conversion.h"
+#include "occupancy_palette.h"
 
 namespace rviz
 {
 
+namespace
+{
+
+// minimum time between two snapshot writes, in seconds
+const double SNAPSHOT_INTERVAL = 10.0;
+
+std::string getSnapshotDirectory()
+{
+  std::string ros_home = getRosHomeDirectory();
+  return ros_home.empty() ? ros_home : ros_home + "/rviz_snapshots";
+}
+
+} // namespace
+
 MapDisplayCustom::MapDisplayCustom()
   : Display()
   , manual_object_( NULL )
   , material_( 0 )
+  , palette_program_( false )
+  , palette_opaque_( true )
   , loaded_( false )
   , resolution_( 0.0f )
   , width_( 0 )
@@ -67,6 +94,9 @@ MapDisplayCustom::MapDisplayCustom()
   , orientation_(Ogre::Quaternion::IDENTITY)
   , new_map_(false)
   , priority_(0)
+  , snapshot_restored_(false)
+  , snapshot_dirty_(false)
+  , snapshot_generation_(0)
 {
   topic_property_ = new RosTopicProperty( "Topic", "",
                                           QString::fromStdString( ros::message_traits::datatype<nav_msgs::OccupancyGrid>() ),
@@ -84,6 +114,12 @@ MapDisplayCustom::MapDisplayCustom()
                                        " drawn behind everything else.",
                                        this, SLOT( updateDrawUnder() ));
 
+  color_scheme_property_ = new EnumProperty( "Color Scheme", "map",
+                                             "How the occupancy values are coloured.",
+                                             this, SLOT( updateColorScheme() ));
+  color_scheme_property_->addOption( "map", MAP_COLOR_SCHEME );
+  color_scheme_property_->addOption( "costmap", COSTMAP_COLOR_SCHEME );
+
   resolution_property_ = new FloatProperty( "Resolution", 0,
                                             "Resolution of the map. (not editable)", this );
   resolution_property_->setReadOnly( true );
@@ -111,6 +147,19 @@ MapDisplayCustom::~MapDisplayCustom()
 {
   unsubscribe();
   clear();
+
+  if( !palette_texture_.isNull() )
+  {
+    std::string palette_name = palette_texture_->getName();
+    palette_texture_.setNull();
+    Ogre::TextureManager::getSingleton().remove( palette_name );
+  }
+
+  // the last map may still be within the snapshot interval
+  restore_thread_.join();
+  snapshot_thread_.join();
+  if( snapshot_dirty_ )
+    writeSnapshot( getSnapshotPath(), current_map_ );
 }
 
 void MapDisplayCustom::onInitialize()
@@ -126,6 +175,26 @@ void MapDisplayCustom::onInitialize()
   material_->setCullingMode( Ogre::CULL_NONE );
   material_->setDepthWriteEnabled(false);
 
+  // without GLSL the maps are converted to luminance and always drawn with the map scheme
+  palette_program_ = isPaletteProgramSupported();
+  color_scheme_property_->setHidden( !palette_program_ );
+  if( palette_program_ )
+  {
+    palette_texture_ = Ogre::TextureManager::getSingleton().createManual( ss.str() + "Palette", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                                                          Ogre::TEX_TYPE_1D, OCCUPANCY_PALETTE_SIZE, 1, 0, Ogre::PF_BYTE_RGBA,
+                                                                          Ogre::TU_DYNAMIC_WRITE_ONLY );
+
+    Ogre::Pass* pass = material_->getTechnique(0)->getPass(0);
+    pass->setFragmentProgram( getPaletteProgram() );
+    Ogre::TextureUnitState* map_unit = pass->createTextureUnitState();
+    map_unit->setTextureFiltering( Ogre::TFO_NONE );
+    Ogre::TextureUnitState* palette_unit = pass->createTextureUnitState( palette_texture_->getName() );
+    palette_unit->setTextureFiltering( Ogre::TFO_NONE );
+    palette_unit->setTextureAddressingMode( Ogre::TextureUnitState::TAM_CLAMP );
+
+    updateColorScheme();
+  }
+
   updateAlpha();
 }
 
@@ -158,12 +227,28 @@ void MapDisplayCustom::subscribe()
     {
       setStatus( StatusProperty::Error, "Topic", QString( "Error subscribing: " ) + e.what() );
     }
+
+    // partial updates follow the map_server convention of a "_updates" topic next to the map,
+    // none of them may be dropped
+    try
+    {
+      update_sub_ = update_nh_.subscribe( topic_property_->getTopicStd() + "_updates", 100, &MapDisplayCustom::incomingUpdate, this );
+      setStatus( StatusProperty::Ok, "Update Topic", "OK" );
+    }
+    catch( ros::Exception& e )
+    {
+      setStatus( StatusProperty::Error, "Update Topic", QString( "Error subscribing: " ) + e.what() );
+    }
   }
 }
 
 void MapDisplayCustom::unsubscribe()
 {
   map_sub_.shutdown();
+  update_sub_.shutdown();
+
+  boost::mutex::scoped_lock lock(mutex_);
+  pending_updates_.clear();
 }
 
 void MapDisplayCustom::updateAlpha()
@@ -171,19 +256,26 @@ void MapDisplayCustom::updateAlpha()
   float alpha = alpha_property_->getFloat();
 
   Ogre::Pass* pass = material_->getTechnique( 0 )->getPass( 0 );
-  Ogre::TextureUnitState* tex_unit = NULL;
-  if( pass->getNumTextureUnitStates() > 0 )
+  if( palette_program_ )
   {
-    tex_unit = pass->getTextureUnitState( 0 );
+    pass->getFragmentProgramParameters()->setNamedConstant( "alpha", alpha );
   }
   else
   {
-    tex_unit = pass->createTextureUnitState();
-  }
+    Ogre::TextureUnitState* tex_unit = NULL;
+    if( pass->getNumTextureUnitStates() > 0 )
+    {
+      tex_unit = pass->getTextureUnitState( 0 );
+    }
+    else
+    {
+      tex_unit = pass->createTextureUnitState();
+    }
 
-  tex_unit->setAlphaOperation( Ogre::LBX_SOURCE1, Ogre::LBS_MANUAL, Ogre::LBS_CURRENT, alpha );
+    tex_unit->setAlphaOperation( Ogre::LBX_SOURCE1, Ogre::LBS_MANUAL, Ogre::LBS_CURRENT, alpha );
+  }
 
-  if( alpha < 0.9998 )
+  if( alpha < 0.9998 || !palette_opaque_ )
   {
     material_->setSceneBlending( Ogre::SBT_TRANSPARENT_ALPHA );
     material_->setDepthWriteEnabled( false );
@@ -195,11 +287,32 @@ void MapDisplayCustom::updateAlpha()
   }
 }
 
+void MapDisplayCustom::updateColorScheme()
+{
+  if( !palette_program_ )
+  {
+    return;
+  }
+
+  // only the 256 palette colours are uploaded, the map texture stays as it is
+  std::vector<unsigned char> palette( OCCUPANCY_PALETTE_SIZE * 4 );
+  OccupancyColorScheme scheme = (OccupancyColorScheme)color_scheme_property_->getOptionInt();
+  bool opaque = makeOccupancyPalette( scheme, &palette[0] );
+  palette_texture_->getBuffer()->blitFromMemory( Ogre::PixelBox( OCCUPANCY_PALETTE_SIZE, 1, 1, Ogre::PF_BYTE_RGBA, &palette[0] ));
+
+  if( opaque != palette_opaque_ )
+  {
+    palette_opaque_ = opaque;
+    updateAlpha();
+  }
+  context_->queueRender();
+}
+
 void MapDisplayCustom::updateDrawUnder()
 {
   bool draw_under = draw_under_property_->getValue().toBool();
 
-  if( alpha_property_->getFloat() >= 0.9998 )
+  if( alpha_property_->getFloat() >= 0.9998 && palette_opaque_ )
   {
     material_->setDepthWriteEnabled( !draw_under );
   }
@@ -220,8 +333,24 @@ void MapDisplayCustom::updateDrawUnder()
 void MapDisplayCustom::updateTopic()
 {
   unsubscribe();
-  subscribe();
   clear();
+
+  // the maps came from the old topic, the snapshot of the new one is restored on the next frame
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    updated_map_.reset();
+    new_map_ = false;
+    pending_updates_.clear();
+    restored_map_.reset();
+    snapshot_generation_++;
+  }
+  current_map_.reset();
+  editable_map_.reset();
+  snapshot_map_.reset();
+  snapshot_dirty_ = false;
+  snapshot_restored_ = false;
+
+  subscribe();
 }
 
 void MapDisplayCustom::clear()
@@ -236,9 +365,10 @@ void MapDisplayCustom::clear()
   scene_manager_->destroyManualObject( manual_object_ );
   manual_object_ = NULL;
 
+  // removed rather than unloaded, every map texture has a new name and would stay registered
   std::string tex_name = texture_->getName();
   texture_.setNull();
-  Ogre::TextureManager::getSingleton().unload( tex_name );
+  Ogre::TextureManager::getSingleton().remove( tex_name );
 
   loaded_ = false;
 }
@@ -256,24 +386,56 @@ void MapDisplayCustom::update( float wall_dt, float ros_dt )
   if(manual_object_)
     manual_object_->setRenderQueueGroupAndPriority( Ogre::RENDER_QUEUE_MAIN, priority_ );
 
+  if( !snapshot_restored_ )
+  {
+    restoreSnapshot();
+  }
+  saveSnapshot();
+
+  bool new_map;
+  bool restored = false;
+  std::deque<map_msgs::OccupancyGridUpdate::ConstPtr> updates;
   {
     boost::mutex::scoped_lock lock(mutex_);
 
-    current_map_ = updated_map_;
+    new_map = new_map_ && updated_map_ && !updated_map_->data.empty();
+    if( new_map )
+    {
+      restored = updated_map_ == restored_map_;
+      restored_map_.reset();
+      current_map_ = updated_map_;
+      editable_map_.reset();
+      new_map_ = false;
+    }
+    updates.swap( pending_updates_ );
   }
 
-  if (!current_map_ || !new_map_)
+  if( restored )
   {
-    return;
+    // already on disk, it isn't written back
+    snapshot_map_ = current_map_;
+    setStatus( StatusProperty::Ok, "Snapshot", QString::fromStdString( "Restored the last map from " + getSnapshotPath() ));
   }
 
-  if (current_map_->data.empty())
+  if( new_map )
   {
-    return;
+    showMap();
   }
 
-  new_map_ = false;
+  // a map drawn downsampled can't be patched, it is rebuilt once after all updates
+  bool rebuild = false;
+  for( size_t i = 0; i < updates.size(); i++ )
+  {
+    rebuild = !applyUpdate( *updates[i] ) || rebuild;
+  }
+  if( rebuild )
+  {
+    showMap();
+  }
+}
 
+void MapDisplayCustom::showMap()
+{
   if( !validateFloats( *current_map_ ))
   {
     setStatus( StatusProperty::Error, "Map", "Message contained invalid floating point values (nans or infs)" );
@@ -288,10 +450,6 @@ void MapDisplayCustom::update( float wall_dt, float ros_dt )
     return;
   }
 
-  clear();
-
-  setStatus( StatusProperty::Ok, "Message", "Map received" );
-
   ROS_DEBUG( "Received a %d X %d map @ %.3f m/pix\n",
              current_map_->info.width,
              current_map_->info.height,
@@ -302,6 +460,15 @@ void MapDisplayCustom::update( float wall_dt, float ros_dt )
   int width = current_map_->info.width;
   int height = current_map_->info.height;
 
+  // the texture and the quad are kept while the size of the map doesn't change, new maps are
+  // written into the texture; a downsampled texture is kept as well, writeMap shrinks every map
+  bool reuse = loaded_ && width == width_ && height == height_ && resolution == resolution_;
+  if( !reuse )
+  {
+    clear();
+  }
+
+  setStatus( StatusProperty::Ok, "Message", "Map received" );
 
   Ogre::Vector3 position( current_map_->info.origin.position.x,
                           current_map_->info.origin.position.y,
@@ -316,96 +483,97 @@ void MapDisplayCustom::update( float wall_dt, float ros_dt )
     frame_ = "/map";
   }
 
-  // Expand it to be RGB data
-  unsigned int pixels_size = width * height;
-  unsigned char* pixels = new unsigned char[pixels_size];
-  memset(pixels, 255, pixels_size);
-
   bool map_status_set = false;
-  unsigned int num_pixels_to_copy = pixels_size;
-  if( pixels_size != current_map_->data.size() )
+  if( (size_t)width * height != current_map_->data.size() )
   {
     std::stringstream ss;
     ss << "Data size doesn't match width*height: width = " << width
        << ", height = " << height << ", data size = " << current_map_->data.size();
     setStatus( StatusProperty::Error, "Map", QString::fromStdString( ss.str() ));
     map_status_set = true;
-
-    // Keep going, but don't read past the end of the data.
-    if( current_map_->data.size() < pixels_size )
-    {
-      num_pixels_to_copy = current_map_->data.size();
-    }
   }
 
-  // TODO: a fragment shader could do this on the video card, and
-  // would allow a non-grayscale color to mark the out-of-range
-  // values.
-  for( unsigned int pixel_index = 0; pixel_index < num_pixels_to_copy; pixel_index++ )
+  if( !reuse )
   {
-    unsigned char val;
-    int8_t data = current_map_->data[ pixel_index ];
-    if( data > 100 )
-      val = 127;
-    else if( data < 0 )
-      val = 127;
-    else
-      val = int8_t((int(100 - data) * 255) / 100);
+    createMap( width, height, resolution );
+  }
+  if( !writeMap() )
+  {
+    map_status_set = true;
+  }
 
-    pixels[ pixel_index ] = val;
+  if( !map_status_set )
+  {
+    setStatus( StatusProperty::Ok, "Map", "Map OK" );
   }
 
-  Ogre::DataStreamPtr pixel_stream;
-  pixel_stream.bind( new Ogre::MemoryDataStream( pixels, pixels_size ));
+  resolution_property_->setValue( resolution );
+  width_property_->setValue( width );
+  height_property_->setValue( height );
+  position_property_->setVector( position );
+  orientation_property_->setQuaternion( orientation );
+
+  resolution_ = resolution;
+  width_ = width;
+  height_ = height;
+  position_ = position;
+  orientation_ = orientation;
+
+  transformMap();
+
+  loaded_ = true;
+  snapshot_dirty_ = snapshot_dirty_ || current_map_ != snapshot_map_;
+
+  context_->queueRender();
+}
+
+void MapDisplayCustom::createMap( int width, int height, float resolution )
+{
   static int tex_count = 0;
   std::stringstream ss;
   ss << "MapTexture" << tex_count++;
-  try
-  {
-    texture_ = Ogre::TextureManager::getSingleton().loadRawData( ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-                                                                 pixel_stream, width, height, Ogre::PF_L8, Ogre::TEX_TYPE_2D,
-                                                                 0);
-
-    if( !map_status_set )
-    {
-      setStatus( StatusProperty::Ok, "Map", "Map OK" );
-    }
-  }
-  catch(Ogre::RenderingAPIException&)
+  // a map size the graphics card refused before is downsampled right away, without failing and
+  // warning again
+  std::pair<int, int> map_size( width, height );
+  std::map<std::pair<int, int>, std::pair<int, int> >::iterator downsampled = downsampled_sizes_.find( map_size );
+  if( downsampled == downsampled_sizes_.end() )
   {
-    Ogre::Image image;
-    pixel_stream->seek(0);
-    float fwidth = width;
-    float fheight = height;
-    if( width > height )
-    {
-      float aspect = fheight / fwidth;
-      fwidth = 2048;
-      fheight = fwidth * aspect;
-    }
-    else
+    try
     {
-      float aspect = fwidth / fheight;
-      fheight = 2048;
-      fwidth = fheight * aspect;
+      // dynamic, maps of the same size are written straight into it
+      texture_ = Ogre::TextureManager::getSingleton().createManual( ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                                                    Ogre::TEX_TYPE_2D, width, height, 0, Ogre::PF_L8,
+                                                                    Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE );
     }
-
+    catch(Ogre::RenderingAPIException&)
     {
-      std::stringstream ss;
-      ss << "Map is larger than your graphics card supports.  Downsampled from [" << width << "x" << height << "] to [" << fwidth << "x" << fheight << "]";
-      setStatus(StatusProperty::Ok, "Map", QString::fromStdString( ss.str() ));
+      float fwidth = width;
+      float fheight = height;
+      if( width > height )
+      {
+        float aspect = fheight / fwidth;
+        fwidth = 2048;
+        fheight = fwidth * aspect;
+      }
+      else
+      {
+        float aspect = fwidth / fheight;
+        fheight = 2048;
+        fwidth = fheight * aspect;
+      }
+
+      ROS_WARN("Failed to create full-size map texture, likely because your graphics card does not support textures of size > 2048.  Downsampling to [%d x %d]...", (int)fwidth, (int)fheight);
+      downsampled = downsampled_sizes_.insert( std::make_pair( map_size, std::make_pair( (int)fwidth, (int)fheight ))).first;
     }
-
-    ROS_WARN("Failed to create full-size map texture, likely because your graphics card does not support textures of size > 2048.  Downsampling to [%d x %d]...", (int)fwidth, (int)fheight);
-    //ROS_INFO("Stream size [%d], width [%f], height [%f], w * h [%f]", pixel_stream->size(), width, height, width * height);
-    image.loadRawData(pixel_stream, width, height, Ogre::PF_L8);
-    image.resize(fwidth, fheight, Ogre::Image::FILTER_NEAREST);
+  }
+  if( downsampled != downsampled_sizes_.end() )
+  {
     ss << "Downsampled";
-    texture_ = Ogre::TextureManager::getSingleton().loadImage(ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, image);
+    texture_ = Ogre::TextureManager::getSingleton().createManual( ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                                                  Ogre::TEX_TYPE_2D, downsampled->second.first, downsampled->second.second,
+                                                                  0, Ogre::PF_L8, Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE );
   }
 
-  delete [] pixels;
-
   Ogre::Pass* pass = material_->getTechnique(0)->getPass(0);
   Ogre::TextureUnitState* tex_unit = NULL;
   if (pass->getNumTextureUnitStates() > 0)
@@ -470,28 +638,137 @@ void MapDisplayCustom::update( float wall_dt, float ros_dt )
   {
     manual_object_->setRenderQueueGroup(Ogre::RENDER_QUEUE_4);
   }
+}
 
-  resolution_property_->setValue( resolution );
-  width_property_->setValue( width );
-  height_property_->setValue( height );
-  position_property_->setVector( position );
-  orientation_property_->setQuaternion( orientation );
+bool MapDisplayCustom::writeMap()
+{
+  int width = current_map_->info.width;
+  int height = current_map_->info.height;
+  const std::vector<int8_t>& cells = current_map_->data;
 
-  transformMap();
+  if( texture_->getWidth() == (uint32_t)width && texture_->getHeight() == (uint32_t)height )
+  {
+    // written straight into the locked texture, the old contents are discarded so the driver
+    // doesn't have to preserve or wait for them
+    Ogre::HardwarePixelBufferSharedPtr buffer = texture_->getBuffer();
+    const Ogre::PixelBox& box = buffer->lock( Ogre::Image::Box( 0, 0, width, height ), Ogre::HardwareBuffer::HBL_DISCARD );
+    writeCells( cells, width, height, box );
+    buffer->unlock();
+    return true;
+  }
 
-  loaded_ = true;
+  // the texture is smaller than the map, which is written and shrunk on the CPU; the nearest
+  // filter keeps the raw cells for the palette
+  std::vector<unsigned char> pixels( (size_t)width * height );
+  writeCells( cells, width, height, Ogre::PixelBox( width, height, 1, Ogre::PF_L8, &pixels[0] ));
+  Ogre::DataStreamPtr pixel_stream;
+  pixel_stream.bind( new Ogre::MemoryDataStream( &pixels[0], pixels.size() ));
+  Ogre::Image image;
+  image.loadRawData( pixel_stream, width, height, Ogre::PF_L8 );
+  image.resize( texture_->getWidth(), texture_->getHeight(), Ogre::Image::FILTER_NEAREST );
+  texture_->getBuffer()->blitFromMemory( image.getPixelBox() );
 
-  context_->queueRender();
+  std::stringstream ss;
+  ss << "Map is larger than your graphics card supports.  Downsampled from [" << width << "x" << height << "] to [" << texture_->getWidth() << "x" << texture_->getHeight() << "]";
+  setStatus(StatusProperty::Ok, "Map", QString::fromStdString( ss.str() ));
+  return false;
 }
 
-void MapDisplayCustom::incomingMap(const nav_msgs::OccupancyGrid::ConstPtr& msg)
+void MapDisplayCustom::writeCells( const std::vector<int8_t>& cells, int width, int height, const Ogre::PixelBox& box )
 {
+  unsigned char* pixels = static_cast<unsigned char*>( box.data );
+  if( !palette_program_ )
+  {
+    const int8_t* data = cells.empty() ? NULL : &cells[0];
+    convertOccupancyRows( data, cells.size(), width, height, pixels, box.rowPitch );
+    return;
+  }
 
-  updated_map_ = msg;
+  for( int row = 0; row < height; row++ )
+  {
+    // rows past the end of short data stay free
+    size_t begin = (size_t)row * width;
+    size_t count = begin < cells.size() ? std::min<size_t>( width, cells.size() - begin ) : 0;
+    unsigned char* line = pixels + row * box.rowPitch;
+    if( count > 0 )
+    {
+      memcpy( line, &cells[begin], count );
+    }
+    memset( line + count, 0, width - count );
+  }
+}
+
+void MapDisplayCustom::incomingMap(const nav_msgs::OccupancyGrid::ConstPtr& msg)
+{
   boost::mutex::scoped_lock lock(mutex_);
+  updated_map_ = msg;
   new_map_ = true;
 }
 
+void MapDisplayCustom::incomingUpdate(const map_msgs::OccupancyGridUpdate::ConstPtr& msg)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  pending_updates_.push_back( msg );
+}
+
+bool MapDisplayCustom::applyUpdate( const map_msgs::OccupancyGridUpdate& update )
+{
+  // updates need a base map, and the ones sent before it are already part of it
+  if( !loaded_ || !current_map_ || update.header.stamp < current_map_->header.stamp )
+  {
+    return true;
+  }
+
+  const nav_msgs::MapMetaData& info = current_map_->info;
+  if( update.x < 0 || update.y < 0 ||
+      (uint64_t)update.x + update.width > info.width ||
+      (uint64_t)update.y + update.height > info.height ||
+      update.data.size() != (size_t)update.width * update.height ||
+      current_map_->data.size() != (size_t)info.width * info.height )
+  {
+    std::stringstream ss;
+    ss << "Update [" << update.x << ", " << update.y << ", " << update.width << "x" << update.height
+       << "] with " << update.data.size() << " cells doesn't fit the " << info.width << "x" << info.height << " map";
+    setStatus( StatusProperty::Error, "Update", QString::fromStdString( ss.str() ));
+    return true;
+  }
+  if( update.width == 0 || update.height == 0 )
+  {
+    return true;
+  }
+
+  // the received map is shared with the subscriber and the snapshot writer, so it is copied once
+  // and following updates patch the copy
+  if( current_map_ != editable_map_ )
+  {
+    editable_map_.reset( new nav_msgs::OccupancyGrid( *current_map_ ));
+    current_map_ = editable_map_;
+  }
+  for( uint32_t row = 0; row < update.height; row++ )
+  {
+    memcpy( &editable_map_->data[( update.y + row ) * info.width + update.x],
+            &update.data[row * update.width], update.width );
+  }
+  snapshot_dirty_ = true;
+
+  if( texture_->getWidth() != info.width || texture_->getHeight() != info.height )
+  {
+    return false;
+  }
+
+  // only the changed rectangle is locked and written; the rest of the texture has to be
+  // kept, so it isn't discarded
+  Ogre::HardwarePixelBufferSharedPtr buffer = texture_->getBuffer();
+  const Ogre::PixelBox& box = buffer->lock( Ogre::Image::Box( update.x, update.y, update.x + update.width, update.y + update.height ),
+                                            Ogre::HardwareBuffer::HBL_NORMAL );
+  writeCells( update.data, update.width, update.height, box );
+  buffer->unlock();
+
+  setStatus( StatusProperty::Ok, "Update", "Map updated" );
+  context_->queueRender();
+  return true;
+}
+
 
 
 void MapDisplayCustom::transformMap()
@@ -534,6 +811,165 @@ void MapDisplayCustom::reset()
   updateTopic();
 }
 
+std::string MapDisplayCustom::getSnapshotPath()
+{
+  std::string directory = getSnapshotDirectory();
+  if( directory.empty() || topic_property_->getTopic().isEmpty() )
+    return std::string();
+
+  std::string name = "map" + topic_property_->getTopicStd();
+  for( size_t i = 0; i < name.size(); i++ )
+  {
+    if( !isalnum( name[i] ) && name[i] != '-' && name[i] != '.' )
+      name[i] = '_';
+  }
+  return directory + "/" + name + ".snapshot";
+}
+
+void MapDisplayCustom::restoreSnapshot()
+{
+  // the read of a previous topic is not waited for, the snapshot is restored on a later frame
+  if( !restore_thread_.timed_join( boost::posix_time::seconds( 0 )))
+  {
+    return;
+  }
+  snapshot_restored_ = true;
+
+  std::string path = getSnapshotPath();
+  if( path.empty() || current_map_ )
+  {
+    return;
+  }
+
+  // read on a thread, the map then arrives like a received one
+  unsigned int generation;
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    generation = snapshot_generation_;
+  }
+  restore_thread_ = boost::thread( boost::bind( &MapDisplayCustom::loadSnapshot, this, path, generation ));
+}
+
+void MapDisplayCustom::loadSnapshot( const std::string& path, unsigned int generation )
+{
+  nav_msgs::OccupancyGrid::Ptr map = readSnapshot( path );
+  if( !map )
+  {
+    return;
+  }
+
+  // shown until the publisher sends a new map, which then replaces it as usual; a map received
+  // during the read or a topic change wins
+  boost::mutex::scoped_lock lock(mutex_);
+  if( generation != snapshot_generation_ || updated_map_ )
+  {
+    return;
+  }
+  updated_map_ = map;
+  restored_map_ = map;
+  new_map_ = true;
+}
+
+void MapDisplayCustom::saveSnapshot()
+{
+  if( !snapshot_dirty_ || ros::WallTime::now() < next_snapshot_time_ )
+  {
+    return;
+  }
+
+  // a write that is still running is not waited for, the map is saved on a later frame
+  if( !snapshot_thread_.timed_join( boost::posix_time::seconds( 0 )))
+  {
+    return;
+  }
+
+  std::string path = getSnapshotPath();
+  if( !path.empty() )
+  {
+    // received maps are immutable, so the writer can share them; a map patched by updates keeps
+    // changing and is copied
+    nav_msgs::OccupancyGrid::ConstPtr map = current_map_;
+    if( map == editable_map_ )
+    {
+      map.reset( new nav_msgs::OccupancyGrid( *editable_map_ ));
+    }
+    snapshot_thread_ = boost::thread( boost::bind( &MapDisplayCustom::writeSnapshot, path, map ));
+  }
+  snapshot_map_ = current_map_;
+  snapshot_dirty_ = false;
+  next_snapshot_time_ = ros::WallTime::now() + ros::WallDuration( SNAPSHOT_INTERVAL );
+}
+
+bool MapDisplayCustom::writeSnapshot( const std::string& path, const nav_msgs::OccupancyGrid::ConstPtr& map )
+{
+  std::string directory = path.substr( 0, path.rfind( '/' ));
+  if( !map || !makeDirectories( directory ))
+  {
+    return false;
+  }
+
+  // the message md5 comes first, so snapshots of an older message definition are ignored. The
+  // cells end the serialized message, so only the header, the info and the cell count are
+  // serialized into a buffer and the cells are written straight from the map
+  std::string md5 = ros::message_traits::md5sum<nav_msgs::OccupancyGrid>();
+  uint32_t cell_count = map->data.size();
+  std::vector<uint8_t> buffer( ros::serialization::serializationLength( map->header ) +
+                               ros::serialization::serializationLength( map->info ) + sizeof(cell_count) );
+  ros::serialization::OStream stream( &buffer[0], buffer.size() );
+  ros::serialization::serialize( stream, map->header );
+  ros::serialization::serialize( stream, map->info );
+  ros::serialization::serialize( stream, cell_count );
+
+  // written under a temporary name and renamed, so a crash never leaves a half written snapshot
+  std::stringstream temp_path;
+  temp_path << path << "." << getpid() << ".tmp";
+  FILE* file = fopen( temp_path.str().c_str(), "wb" );
+  bool ok = file != NULL &&
+            fwrite( md5.data(), md5.size(), 1, file ) == 1 &&
+            fwrite( &buffer[0], buffer.size(), 1, file ) == 1 &&
+            ( cell_count == 0 || fwrite( &map->data[0], cell_count, 1, file ) == 1 );
+  if( file != NULL )
+  {
+    ok = fclose( file ) == 0 && ok;
+  }
+  ok = ok && rename( temp_path.str().c_str(), path.c_str() ) == 0;
+  if( !ok )
+  {
+    unlink( temp_path.str().c_str() );
+    ROS_WARN( "MapDisplayCustom: cannot write snapshot %s", path.c_str() );
+  }
+  return ok;
+}
+
+nav_msgs::OccupancyGrid::Ptr MapDisplayCustom::readSnapshot( const std::string& path )
+{
+  MappedFile file;
+  if( !file.open( path ))
+  {
+    return nav_msgs::OccupancyGrid::Ptr();
+  }
+
+  // deserialized straight out of the mapping, the cells are copied once into the message
+  nav_msgs::OccupancyGrid::Ptr map( new nav_msgs::OccupancyGrid() );
+  std::string md5 = ros::message_traits::md5sum<nav_msgs::OccupancyGrid>();
+  const uint8_t* bytes = file.getData();
+  if( file.getSize() < md5.size() || md5.compare( 0, md5.size(), (const char*)bytes, md5.size() ) != 0 )
+  {
+    return nav_msgs::OccupancyGrid::Ptr();
+  }
+  try
+  {
+    // IStream only reads, it just takes a non-const pointer
+    ros::serialization::IStream stream( const_cast<uint8_t*>( bytes ) + md5.size(), file.getSize() - md5.size() );
+    ros::serialization::deserialize( stream, *map );
+  }
+  catch( ros::serialization::StreamOverrunException& )
+  {
+    map.reset();
+  }
+  return map;
+}
+
 void MapDisplayCustom::setPriority(unsigned short priority)
 {
     priority_ = priority;
@@ -38,6 +38,13 @@
 #include <ros/time.h>
 
 #include <nav_msgs/OccupancyGrid.h>
+#include <map_msgs/OccupancyGridUpdate.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <deque>
+#include <map>
+#include <vector>
 
 #include "rviz/display.h"
 
@@ -49,6 +56,7 @@ class ManualObject;
 namespace rviz
 {
 
+class EnumProperty;
 class FloatProperty;
 class IntProperty;
 class Property;
@@ -81,10 +89,12 @@ public:
 
 public Q_SLOTS:
   void incomingMap( const nav_msgs::OccupancyGrid::ConstPtr& );
+  void incomingUpdate( const map_msgs::OccupancyGridUpdate::ConstPtr& );
   void setPriority( unsigned short );
 
 protected Q_SLOTS:
   void updateAlpha();
+  void updateColorScheme();
   void updateTopic();
   void updateDrawUnder();
 
@@ -98,11 +108,37 @@ protected:
 
   void clear();
 
+  void showMap();
+  // creates the texture and the quad for a map of a new size
+  void createMap( int width, int height, float resolution );
+  // writes the current map into the texture; returns false if it had to be downsampled
+  bool writeMap();
+  // the cells are copied unchanged for the palette program, otherwise converted to luminance
+  void writeCells( const std::vector<int8_t>& cells, int width, int height, const Ogre::PixelBox& box );
+  // writes the rectangle into the map and its texture; returns false if the map has to be rebuilt
+  bool applyUpdate( const map_msgs::OccupancyGridUpdate& update );
+
   void transformMap();
 
+  // The last map is kept in $ROS_HOME/rviz_snapshots, so it is shown right after a restart. The
+  // snapshot is the serialized message rather than the texture: the cells are needed to apply
+  // partial updates and to convert the map again for another texture size.
+  void restoreSnapshot();
+  void loadSnapshot( const std::string& path, unsigned int generation );
+  void saveSnapshot();
+  std::string getSnapshotPath();
+  static bool writeSnapshot( const std::string& path, const nav_msgs::OccupancyGrid::ConstPtr& map );
+  static nav_msgs::OccupancyGrid::Ptr readSnapshot( const std::string& path );
+
   Ogre::ManualObject* manual_object_;
   Ogre::TexturePtr texture_;
+  // texture size used for every map size the graphics card couldn't create a texture for
+  std::map<std::pair<int, int>, std::pair<int, int> > downsampled_sizes_;
   Ogre::MaterialPtr material_;
+  // the cells are coloured by a fragment program looking them up in the palette texture
+  bool palette_program_;
+  Ogre::TexturePtr palette_texture_;
+  bool palette_opaque_;
   bool loaded_;
 
   std::string topic_;
@@ -114,6 +150,7 @@ protected:
   std::string frame_;
 
   ros::Subscriber map_sub_;
+  ros::Subscriber update_sub_;
 
   RosTopicProperty* topic_property_;
   FloatProperty* resolution_property_;
@@ -123,13 +160,29 @@ protected:
   QuaternionProperty* orientation_property_;
   FloatProperty* alpha_property_;
   Property* draw_under_property_;
+  EnumProperty* color_scheme_property_;
 
   nav_msgs::OccupancyGrid::ConstPtr updated_map_;
   nav_msgs::OccupancyGrid::ConstPtr current_map_;
+  // copy of the current map patched by the partial updates, equal to current_map_ once there was one
+  nav_msgs::OccupancyGrid::Ptr editable_map_;
+  std::deque<map_msgs::OccupancyGridUpdate::ConstPtr> pending_updates_;
   boost::mutex mutex_;
   bool new_map_;
 
   unsigned short priority_;
+
+  bool snapshot_restored_;
+  // set when the displayed map is newer than the snapshot on disk
+  bool snapshot_dirty_;
+  nav_msgs::OccupancyGrid::ConstPtr snapshot_map_;
+  ros::WallTime next_snapshot_time_;
+  boost::thread snapshot_thread_;
+  // counts topic changes, so a snapshot read for an older topic is dropped; guarded by mutex_
+  unsigned int snapshot_generation_;
+  // the map read from the snapshot while it is in updated_map_; guarded by mutex_
+  nav_msgs::OccupancyGrid::ConstPtr restored_map_;
+  boost::thread restore_thread_;
 };
 
 } // namespace rviz
@@ -0,0 +1,157 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <string.h>
+
+#include "parallel_for.h"
+
+#include "occupancy_conversion.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// at least this many cells per thread, smaller maps are converted faster than threads start
+const size_t PARALLEL_MIN_CELLS = 1 << 20;
+
+struct OccupancyTable
+{
+  OccupancyTable()
+  {
+    for( int i = 0; i < 256; i++ )
+    {
+      int8_t data = (int8_t)i;
+      if( data > 100 || data < 0 )
+        values[i] = 127;
+      else
+        values[i] = (unsigned char)(( int( 100 - data ) * 255 ) / 100 );
+    }
+  }
+
+  unsigned char values[256];
+};
+
+const OccupancyTable TABLE;
+
+/*
+ * The vector paths compute the same table: cells are compared as unsigned bytes, so negative
+ * values count as above 100, and (100 - cell) * 255 / 100 is done in 16 bit lanes with the
+ * division as a multiply by 2^22 / 100 (rounded up) and a shift, which is exact for the
+ * products up to 25500.
+ */
+const int DIVIDE_BY_100_MULTIPLIER = 41944;
+const int DIVIDE_BY_100_SHIFT = 6;
+
+#if defined( __SSE2__ )
+
+size_t convertVector( const int8_t* cells, unsigned char* pixels, size_t count )
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i max_valid = _mm_set1_epi8( 100 );
+  const __m128i unknown = _mm_set1_epi8( 127 );
+  const __m128i hundred = _mm_set1_epi16( 100 );
+  const __m128i scale = _mm_set1_epi16( 255 );
+  const __m128i multiplier = _mm_set1_epi16( (short)DIVIDE_BY_100_MULTIPLIER );
+
+  size_t i = 0;
+  for( ; i + 16 <= count; i += 16 )
+  {
+    __m128i v = _mm_loadu_si128( (const __m128i*)( cells + i ));
+    __m128i valid = _mm_cmpeq_epi8( _mm_min_epu8( v, max_valid ), v );
+    __m128i low = _mm_mullo_epi16( _mm_sub_epi16( hundred, _mm_unpacklo_epi8( v, zero )), scale );
+    __m128i high = _mm_mullo_epi16( _mm_sub_epi16( hundred, _mm_unpackhi_epi8( v, zero )), scale );
+    low = _mm_srli_epi16( _mm_mulhi_epu16( low, multiplier ), DIVIDE_BY_100_SHIFT );
+    high = _mm_srli_epi16( _mm_mulhi_epu16( high, multiplier ), DIVIDE_BY_100_SHIFT );
+    __m128i converted = _mm_packus_epi16( low, high );
+    __m128i result = _mm_or_si128( _mm_and_si128( valid, converted ), _mm_andnot_si128( valid, unknown ));
+    _mm_storeu_si128( (__m128i*)( pixels + i ), result );
+  }
+  return i;
+}
+
+#else
+
+size_t convertVector( const int8_t*, unsigned char*, size_t )
+{
+  return 0;
+}
+
+#endif
+
+void convertRows( const int8_t* cells, size_t cell_count, uint32_t width, unsigned char* pixels, size_t row_pitch,
+                  size_t, size_t begin, size_t end )
+{
+  for( size_t row = begin; row < end; row++ )
+  {
+    size_t first = row * width;
+    size_t count = first < cell_count ? std::min<size_t>( width, cell_count - first ) : 0;
+    unsigned char* line = pixels + row * row_pitch;
+    if( count > 0 )
+    {
+      convertOccupancy( cells + first, line, count );
+    }
+    memset( line + count, 255, width - count );
+  }
+}
+
+} // namespace
+
+void convertOccupancy( const int8_t* cells, unsigned char* pixels, size_t count )
+{
+  size_t i = convertVector( cells, pixels, count );
+  for( ; i < count; i++ )
+    pixels[i] = TABLE.values[(uint8_t)cells[i]];
+}
+
+void convertOccupancyRows( const int8_t* cells, size_t cell_count, uint32_t width, uint32_t height,
+                           unsigned char* pixels, size_t row_pitch )
+{
+  if( width == 0 )
+    return;
+
+  size_t min_rows = std::max<size_t>( PARALLEL_MIN_CELLS / width, 1 );
+  parallelFor( height, getParallelRangeCount( height, min_rows ),
+               boost::bind( &convertRows, cells, cell_count, width, pixels, row_pitch, _1, _2, _3 ));
+}
+
+} // namespace rviz
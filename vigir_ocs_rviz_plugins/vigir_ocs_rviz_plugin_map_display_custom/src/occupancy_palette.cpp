@@ -0,0 +1,143 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <OGRE/OgreHighLevelGpuProgramManager.h>
+
+#include <stdint.h>
+
+#include "occupancy_palette.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// the cells are uploaded unchanged into a luminance texture, the byte is found again from the
+// normalized value and looked up in the middle of its palette texel
+const char* PALETTE_FRAGMENT_SOURCE =
+  "uniform sampler2D map_texture;\n"
+  "uniform sampler1D palette_texture;\n"
+  "uniform float alpha;\n"
+  "\n"
+  "void main()\n"
+  "{\n"
+  "  float cell = texture2D( map_texture, gl_TexCoord[0].xy ).r;\n"
+  "  vec4 colour = texture1D( palette_texture, ( cell * 255.0 + 0.5 ) / 256.0 );\n"
+  "  gl_FragColor = vec4( colour.rgb, colour.a * alpha );\n"
+  "}\n";
+
+void setColor( unsigned char* rgba, int index, unsigned char r, unsigned char g, unsigned char b, unsigned char a )
+{
+  unsigned char* color = rgba + 4 * index;
+  color[0] = r;
+  color[1] = g;
+  color[2] = b;
+  color[3] = a;
+}
+
+} // namespace
+
+bool makeOccupancyPalette( OccupancyColorScheme scheme, unsigned char* rgba )
+{
+  bool opaque = true;
+  for( int i = 0; i < (int)OCCUPANCY_PALETTE_SIZE; i++ )
+  {
+    int8_t data = (int8_t)i;
+    if( data == -1 )
+    {
+      // unknown
+      if( scheme == COSTMAP_COLOR_SCHEME )
+        setColor( rgba, i, 0x70, 0x89, 0x86, 0x38 );
+      else
+        setColor( rgba, i, 127, 127, 127, 255 );
+    }
+    else if( data > 100 )
+    {
+      setColor( rgba, i, 0, 255, 0, 255 );
+    }
+    else if( data < 0 )
+    {
+      setColor( rgba, i, 255, 0, 0, 255 );
+    }
+    else if( scheme == COSTMAP_COLOR_SCHEME )
+    {
+      // free is transparent, costs go from blue to red, inscribed is cyan and lethal purple
+      if( data == 0 )
+        setColor( rgba, i, 0, 0, 0, 0 );
+      else if( data == 99 )
+        setColor( rgba, i, 0, 255, 255, 255 );
+      else if( data == 100 )
+        setColor( rgba, i, 255, 0, 255, 255 );
+      else
+      {
+        unsigned char v = (unsigned char)(( 255 * data ) / 100 );
+        setColor( rgba, i, v, 0, 255 - v, 255 );
+      }
+    }
+    else
+    {
+      // free is white and occupied black, as the luminance of the CPU conversion
+      unsigned char v = (unsigned char)(( int( 100 - data ) * 255 ) / 100 );
+      setColor( rgba, i, v, v, v, 255 );
+    }
+    opaque = opaque && rgba[4 * i + 3] == 255;
+  }
+  return opaque;
+}
+
+bool isPaletteProgramSupported()
+{
+  return Ogre::HighLevelGpuProgramManager::getSingleton().isLanguageSupported( "glsl" );
+}
+
+std::string getPaletteProgram()
+{
+  const std::string name = "MapPaletteFragment";
+  if( Ogre::HighLevelGpuProgramManager::getSingleton().resourceExists( name ))
+    return name;
+
+  Ogre::HighLevelGpuProgramPtr program = Ogre::HighLevelGpuProgramManager::getSingleton().createProgram(
+      name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, "glsl", Ogre::GPT_FRAGMENT_PROGRAM );
+  program->setSource( PALETTE_FRAGMENT_SOURCE );
+  program->load();
+
+  Ogre::GpuProgramParametersSharedPtr params = program->getDefaultParameters();
+  params->setNamedConstant( "map_texture", 0 );
+  params->setNamedConstant( "palette_texture", 1 );
+  params->setNamedConstant( "alpha", 1.0f );
+  return name;
+}
+
+} // namespace rviz
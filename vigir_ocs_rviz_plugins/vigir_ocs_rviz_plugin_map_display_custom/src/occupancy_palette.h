@@ -0,0 +1,71 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_OCCUPANCY_PALETTE_H
+#define RVIZ_OCCUPANCY_PALETTE_H
+
+#include <stddef.h>
+
+#include <string>
+
+namespace rviz
+{
+
+enum OccupancyColorScheme
+{
+  MAP_COLOR_SCHEME,
+  COSTMAP_COLOR_SCHEME
+};
+
+const size_t OCCUPANCY_PALETTE_SIZE = 256;
+
+/**
+ * Fills rgba with OCCUPANCY_PALETTE_SIZE colours of 4 bytes, indexed by the cell value as an
+ * unsigned byte. Unknown cells (-1) and values outside of 0..100 get colours of their own.
+ * Returns true if all colours are opaque.
+ */
+bool makeOccupancyPalette( OccupancyColorScheme scheme, unsigned char* rgba );
+
+// the palette is applied by GLSL programs, otherwise maps are converted to luminance on the CPU
+bool isPaletteProgramSupported();
+
+/**
+ * Returns the name of the fragment program drawing the raw cells of texture unit 0 with the
+ * palette of unit 1; its "alpha" constant scales the palette alpha.
+ */
+std::string getPaletteProgram();
+
+} // namespace rviz
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * Tests of the occupancy to luminance conversion.
+ *
+ * Compares the vector paths against the documented formula for every cell value, length and alignment.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "occupancy_conversion.h"
+
+using namespace rviz;
+
+namespace
+{
+
+unsigned char expectedPixel( int8_t cell )
+{
+  if( cell < 0 || cell > 100 )
+    return 127;
+  return (unsigned char)(( 100 - cell ) * 255 / 100 );
+}
+
+} // namespace
+
+TEST( OccupancyConversion, ConvertsEveryValue )
+{
+  std::vector<int8_t> cells( 256 );
+  for( int i = 0; i < 256; i++ )
+    cells[i] = (int8_t)i;
+
+  std::vector<unsigned char> pixels( cells.size() );
+  convertOccupancy( &cells[0], &pixels[0], cells.size() );
+  for( int i = 0; i < 256; i++ )
+    EXPECT_EQ( expectedPixel( cells[i] ), pixels[i] ) << "cell " << (int)cells[i];
+}
+
+TEST( OccupancyConversion, HandlesLengthsAndAlignment )
+{
+  // every length and offset around the vector widths, so the scalar remainder is covered too
+  std::vector<int8_t> cells( 200 );
+  for( size_t i = 0; i < cells.size(); i++ )
+    cells[i] = (int8_t)( i * 37 + 11 );
+
+  for( size_t offset = 0; offset < 4; offset++ )
+  {
+    for( size_t count = 0; count + offset <= 100; count++ )
+    {
+      // a guard byte after the end must stay untouched
+      std::vector<unsigned char> pixels( count + 1, 0xab );
+      convertOccupancy( &cells[offset], &pixels[0], count );
+      for( size_t i = 0; i < count; i++ )
+        ASSERT_EQ( expectedPixel( cells[offset + i] ), pixels[i] ) << "offset " << offset << " count " << count << " cell " << i;
+      ASSERT_EQ( 0xab, pixels[count] ) << "offset " << offset << " count " << count;
+    }
+  }
+}
+
+TEST( OccupancyConversion, ConvertsRowsWithPitch )
+{
+  const uint32_t width = 37, height = 5;
+  const size_t row_pitch = 40;
+
+  // the last two rows are missing and the one before is short
+  std::vector<int8_t> cells( width * 2 + 10 );
+  for( size_t i = 0; i < cells.size(); i++ )
+    cells[i] = (int8_t)( i % 103 );
+
+  std::vector<unsigned char> pixels( row_pitch * height, 0xab );
+  convertOccupancyRows( &cells[0], cells.size(), width, height, &pixels[0], row_pitch );
+  for( uint32_t row = 0; row < height; row++ )
+  {
+    for( uint32_t x = 0; x < width; x++ )
+    {
+      size_t cell = row * width + x;
+      unsigned char expected = cell < cells.size() ? expectedPixel( cells[cell] ) : 255;
+      EXPECT_EQ( expected, pixels[row * row_pitch + x] ) << "row " << row << " x " << x;
+    }
+    // the padding of every row is left alone
+    for( size_t x = width; x < row_pitch; x++ )
+      EXPECT_EQ( 0xab, pixels[row * row_pitch + x] ) << "row " << row << " x " << x;
+  }
+}
+
+TEST( OccupancyConversion, ConvertsLargeGridsInParallel )
+{
+  // large enough to be split into row ranges
+  const uint32_t width = 2000, height = 1500;
+  std::vector<int8_t> cells( (size_t)width * height );
+  for( size_t i = 0; i < cells.size(); i++ )
+    cells[i] = (int8_t)( i * 7 );
+
+  std::vector<unsigned char> pixels( cells.size() );
+  convertOccupancyRows( &cells[0], cells.size(), width, height, &pixels[0], width );
+  size_t mismatches = 0;
+  for( size_t i = 0; i < cells.size(); i++ )
+    mismatches += pixels[i] != expectedPixel( cells[i] );
+  EXPECT_EQ( 0u, mismatches );
+}
+
+TEST( OccupancyConversion, EmptyGrid )
+{
+  unsigned char pixel = 0xab;
+  convertOccupancyRows( NULL, 0, 0, 3, &pixel, 0 );
+  EXPECT_EQ( 0xab, pixel );
+  convertOccupancy( NULL, &pixel, 0 );
+  EXPECT_EQ( 0xab, pixel );
+}
+
+int main( int argc, char** argv )
+{
+  testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,215 @@
+/*
+ * CameraProjector implementation.
+ *
+ * An additional camera whose images are projected onto the mesh.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <OGRE/OgreFrustum.h>
+#include <OGRE/OgreSceneManager.h>
+#include <OGRE/OgreSceneNode.h>
+
+#include <image_transport/camera_common.h>
+
+#include <boost/bind.hpp>
+
+#include "rviz/frame_manager.h"
+#include "rviz/validate_floats.h"
+
+#include "camera_projector.h"
+#include "image_decode_pool.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// two decode threads per additional camera, the display's camera keeps the default pool
+const size_t DECODE_THREADS = 2;
+
+} // namespace
+
+bool validateFloats( const sensor_msgs::CameraInfo& msg )
+{
+  bool valid = true;
+  valid = valid && validateFloats( msg.D );
+  valid = valid && validateFloats( msg.K );
+  valid = valid && validateFloats( msg.R );
+  valid = valid && validateFloats( msg.P );
+  return valid;
+}
+
+Ogre::Matrix4 getCameraProjection( const sensor_msgs::CameraInfo& info, float img_width, float img_height,
+                                   const Ogre::Quaternion& orientation, Ogre::Vector3& position )
+{
+  double fx = info.P[0];
+  double fy = info.P[5];
+
+  // Add the camera's translation relative to the left camera (from P[3]);
+  double tx = -1 * ( info.P[3] / fx );
+  Ogre::Vector3 right = orientation * Ogre::Vector3::UNIT_X;
+  position = position + ( right * tx );
+
+  double ty = -1 * ( info.P[7] / fy );
+  Ogre::Vector3 down = orientation * Ogre::Vector3::UNIT_Y;
+  position = position + ( down * ty );
+
+  // calculate the projection matrix
+  double cx = info.P[2];
+  double cy = info.P[6];
+
+  double far_plane = 100;
+  double near_plane = 0.01;
+
+  Ogre::Matrix4 proj_matrix = Ogre::Matrix4::ZERO;
+
+  proj_matrix[0][0] = 2.0 * fx / img_width;
+  proj_matrix[1][1] = 2.0 * fy / img_height;
+
+  proj_matrix[0][2] = 2.0 * ( 0.5 - cx / img_width );
+  proj_matrix[1][2] = 2.0 * ( cy / img_height - 0.5 );
+
+  proj_matrix[2][2] = -( far_plane + near_plane ) / ( far_plane - near_plane );
+  proj_matrix[2][3] = -2.0 * far_plane * near_plane / ( far_plane - near_plane );
+
+  proj_matrix[3][2] = -1;
+
+  return proj_matrix;
+}
+
+CameraProjector::CameraProjector( Ogre::SceneManager* scene_manager, FrameManager* frame_manager )
+  : scene_manager_( scene_manager )
+  , frame_manager_( frame_manager )
+  , focal_length_( 0.0f )
+  , decode_pool_( NULL )
+{
+  frustum_ = new Ogre::Frustum();
+  node_ = scene_manager_->getRootSceneNode()->createChildSceneNode();
+  node_->attachObject( frustum_ );
+}
+
+CameraProjector::~CameraProjector()
+{
+  image_sub_.shutdown();
+  compressed_sub_.shutdown();
+  caminfo_sub_.shutdown();
+  // the pool delivers into the texture, so it is stopped first
+  delete decode_pool_;
+
+  node_->detachObject( frustum_ );
+  scene_manager_->destroySceneNode( node_ );
+  delete frustum_;
+}
+
+void CameraProjector::subscribe( ros::NodeHandle& nh, const std::string& topic, const std::string& transport, uint32_t queue_size )
+{
+  topic_ = topic;
+
+  if( transport == "compressed" )
+  {
+    decode_pool_ = new ImageDecodePool( boost::bind( &CameraProjector::imageCallback, this, _1 ), DECODE_THREADS );
+    compressed_sub_ = nh.subscribe( topic + "/compressed", queue_size, &CameraProjector::compressedImageCallback, this );
+  }
+  else
+  {
+    image_transport::ImageTransport it( nh );
+    image_sub_ = it.subscribe( topic, queue_size, &CameraProjector::imageCallback, this, image_transport::TransportHints( transport ));
+  }
+
+  caminfo_sub_ = nh.subscribe( image_transport::getCameraInfoTopic( topic ), 1, &CameraProjector::caminfoCallback, this );
+}
+
+bool CameraProjector::update()
+{
+  texture_.update();
+
+  const sensor_msgs::Image::ConstPtr& image = texture_.getImage();
+  sensor_msgs::CameraInfo::ConstPtr info;
+  {
+    boost::mutex::scoped_lock lock( caminfo_mutex_ );
+    info = current_caminfo_;
+  }
+  if( !image || !info || info->P[0] == 0 || !validateFloats( *info ))
+  {
+    focal_length_ = 0.0f;
+    return false;
+  }
+
+  // without a transform for this stamp the camera stays where it was projected last
+  Ogre::Vector3 position;
+  Ogre::Quaternion orientation;
+  if( !frame_manager_->getTransform( image->header.frame_id, image->header.stamp, position, orientation ))
+  {
+    return focal_length_ > 0.0f;
+  }
+
+  // convert vision (Z-forward) frame to ogre frame (Z-out)
+  orientation = orientation * Ogre::Quaternion( Ogre::Degree( 180 ), Ogre::Vector3::UNIT_X );
+
+  // use image size if the camera info has none, the texture may be downsampled
+  float img_width = info->width > 0 ? info->width : image->width;
+  float img_height = info->height > 0 ? info->height : image->height;
+  Ogre::Matrix4 projection = getCameraProjection( *info, img_width, img_height, orientation, position );
+  if( !validateFloats( position ))
+  {
+    focal_length_ = 0.0f;
+    return false;
+  }
+
+  node_->setPosition( position );
+  node_->setOrientation( orientation );
+  frustum_->setCustomProjectionMatrix( true, projection );
+  focal_length_ = info->P[0];
+  return true;
+}
+
+void CameraProjector::imageCallback( const sensor_msgs::Image::ConstPtr& image )
+{
+  texture_.addMessage( image );
+}
+
+void CameraProjector::compressedImageCallback( const sensor_msgs::CompressedImage::ConstPtr& msg )
+{
+  decode_pool_->addMessage( msg );
+}
+
+void CameraProjector::caminfoCallback( const sensor_msgs::CameraInfo::ConstPtr& info )
+{
+  boost::mutex::scoped_lock lock( caminfo_mutex_ );
+  current_caminfo_ = info;
+}
+
+} // namespace rviz
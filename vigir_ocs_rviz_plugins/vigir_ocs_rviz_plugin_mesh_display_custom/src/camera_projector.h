@@ -0,0 +1,132 @@
+/*
+ * CameraProjector declaration.
+ *
+ * An additional camera whose images are projected onto the mesh.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_CAMERA_PROJECTOR_H
+#define RVIZ_CAMERA_PROJECTOR_H
+
+#include <ros/ros.h>
+#include <image_transport/image_transport.h>
+#include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+#include <OGRE/OgreMatrix4.h>
+#include <OGRE/OgreQuaternion.h>
+#include <OGRE/OgreVector3.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "projector_texture.h"
+
+namespace Ogre
+{
+class Frustum;
+class SceneManager;
+class SceneNode;
+}
+
+namespace rviz
+{
+class FrameManager;
+class ImageDecodePool;
+
+bool validateFloats( const sensor_msgs::CameraInfo& msg );
+
+/**
+ * Projection matrix of a camera from its camera info, with the image size used when the camera
+ * info has none. The position is moved by the P[3] and P[7] offsets of stereo cameras.
+ */
+Ogre::Matrix4 getCameraProjection( const sensor_msgs::CameraInfo& info, float img_width, float img_height,
+                                   const Ogre::Quaternion& orientation, Ogre::Vector3& position );
+
+/**
+ * \class CameraProjector
+ * \brief One more camera projected by a MeshDisplayCustom next to its "Image Topic".
+ *
+ * Subscribes to the images and camera info of a topic, streams the images through its own
+ * ProjectorTexture and keeps a frustum at the camera pose of the image shown. Compressed images
+ * are decoded on an ImageDecodePool like the images of the display.
+ */
+class CameraProjector : boost::noncopyable
+{
+public:
+  CameraProjector( Ogre::SceneManager* scene_manager, FrameManager* frame_manager );
+  ~CameraProjector();
+
+  // transport is the image_transport name, "compressed" is decoded in parallel; throws ros::Exception
+  void subscribe( ros::NodeHandle& nh, const std::string& topic, const std::string& transport, uint32_t queue_size );
+
+  // switches to the newest image and moves the frustum to its camera pose; returns false while
+  // there is no image, camera info or transform. Throws UnsupportedImageEncoding
+  bool update();
+
+  const std::string& getTopic() const { return topic_; }
+  ProjectorTexture& getTexture() { return texture_; }
+  Ogre::Frustum* getFrustum() { return frustum_; }
+
+  // horizontal focal length in camera pixels, 0 until the camera is projected
+  float getFocalLength() const { return focal_length_; }
+
+private:
+  void imageCallback( const sensor_msgs::Image::ConstPtr& image );
+  void compressedImageCallback( const sensor_msgs::CompressedImage::ConstPtr& msg );
+  void caminfoCallback( const sensor_msgs::CameraInfo::ConstPtr& info );
+
+  Ogre::SceneManager* scene_manager_;
+  FrameManager* frame_manager_;
+  Ogre::SceneNode* node_;
+  Ogre::Frustum* frustum_;
+  float focal_length_;
+
+  std::string topic_;
+  image_transport::Subscriber image_sub_;
+  ros::Subscriber compressed_sub_;
+  ros::Subscriber caminfo_sub_;
+  ImageDecodePool* decode_pool_;
+
+  ProjectorTexture texture_;
+
+  sensor_msgs::CameraInfo::ConstPtr current_caminfo_;
+  boost::mutex caminfo_mutex_;
+};
+
+} // namespace rviz
+
+#endif
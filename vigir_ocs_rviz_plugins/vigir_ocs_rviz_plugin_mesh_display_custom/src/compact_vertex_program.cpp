@@ -0,0 +1,368 @@
+/*
+ * Mesh material programs.
+ *
+ * GLSL programs that decode the quantized mesh vertex layout and project camera images.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <OGRE/OgreHighLevelGpuProgramManager.h>
+#include <OGRE/OgreResourceGroupManager.h>
+
+#include <sstream>
+
+#include "compact_vertex_program.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// positions arrive as raw 16 bit integers in gl_Vertex, octahedral normals as 16 bit integers
+// in gl_MultiTexCoord0
+const char* DECODE_SOURCE =
+  "uniform vec4 quantize_offset;\n"
+  "uniform vec4 quantize_scale;\n"
+  "\n"
+  "vec4 decodePosition()\n"
+  "{\n"
+  "  return vec4( quantize_offset.xyz + gl_Vertex.xyz * quantize_scale.xyz, 1.0 );\n"
+  "}\n"
+  "\n"
+  "vec3 decodeNormal()\n"
+  "{\n"
+  "  vec2 e = gl_MultiTexCoord0.xy / 32767.0;\n"
+  "  vec3 n = vec3( e, 1.0 - abs( e.x ) - abs( e.y ));\n"
+  "  if( n.z < 0.0 )\n"
+  "    n.xy = ( 1.0 - abs( n.yx )) * vec2( n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0 );\n"
+  "  return normalize( n );\n"
+  "}\n"
+  "\n";
+
+// the float layout is passed through unchanged
+const char* FLOAT_DECODE_SOURCE =
+  "vec4 decodePosition()\n"
+  "{\n"
+  "  return gl_Vertex;\n"
+  "}\n"
+  "\n"
+  "vec3 decodeNormal()\n"
+  "{\n"
+  "  return gl_Normal;\n"
+  "}\n"
+  "\n";
+
+const char* LIGHTING_SOURCE =
+  "uniform mat4 world_view_proj;\n"
+  "uniform mat4 world;\n"
+  "uniform mat4 inverse_transpose_world;\n"
+  "uniform vec4 camera_position;\n"
+  "uniform vec4 light_position;\n"
+  "uniform vec4 light_diffuse;\n"
+  "uniform vec4 light_specular;\n"
+  "uniform vec4 ambient;\n"
+  "uniform vec4 surface_diffuse;\n"
+  "uniform vec4 surface_specular;\n"
+  "uniform vec4 surface_emissive;\n"
+  "uniform float shininess;\n"
+  "\n"
+  "vec3 worldNormal()\n"
+  "{\n"
+  "  return normalize(( inverse_transpose_world * vec4( decodeNormal(), 0.0 )).xyz );\n"
+  "}\n"
+  "\n"
+  "vec4 lightVertex( vec3 world_position, vec3 normal )\n"
+  "{\n"
+  "  // light_position.w is 0 for directional lights\n"
+  "  vec3 to_light = normalize( light_position.xyz - world_position * light_position.w );\n"
+  "  vec3 to_eye = normalize( camera_position.xyz - world_position );\n"
+  "  float diffuse = max( dot( normal, to_light ), 0.0 );\n"
+  "  float specular = diffuse > 0.0 ? pow( max( dot( normal, normalize( to_light + to_eye )), 0.0 ), shininess ) : 0.0;\n"
+  "\n"
+  "  return vec4( surface_emissive.rgb + ambient.rgb +\n"
+  "               surface_diffuse.rgb * light_diffuse.rgb * diffuse +\n"
+  "               surface_specular.rgb * light_specular.rgb * specular, surface_diffuse.a );\n"
+  "}\n"
+  "\n";
+
+// the mesh is drawn without culling, back faces get the colour lit with the flipped normal
+const char* LIGHTING_MAIN_SOURCE =
+  "varying vec4 back_colour;\n"
+  "\n"
+  "void main()\n"
+  "{\n"
+  "  vec4 position = decodePosition();\n"
+  "  vec3 world_position = ( world * position ).xyz;\n"
+  "  vec3 normal = worldNormal();\n"
+  "  gl_FrontColor = lightVertex( world_position, normal );\n"
+  "  back_colour = lightVertex( world_position, -normal );\n"
+  "  gl_Position = world_view_proj * position;\n"
+  "}\n";
+
+const char* TWO_SIDED_FRAGMENT_SOURCE =
+  "varying vec4 back_colour;\n"
+  "\n"
+  "void main()\n"
+  "{\n"
+  "  gl_FragColor = gl_FrontFacing ? gl_Color : back_colour;\n"
+  "}\n";
+
+// the projector coordinates are interpolated undivided, the fragment program divides by w
+std::string getProjectorMainSource( size_t count )
+{
+  std::stringstream source;
+  source << "uniform mat4 projector_matrices[" << count << "];\n"
+         << "varying vec3 surface_position;\n"
+         << "varying vec3 surface_normal;\n"
+         << "varying vec4 back_colour;\n"
+         << "\n"
+         << "void main()\n"
+         << "{\n"
+         << "  vec4 position = decodePosition();\n"
+         << "  vec4 world_position = world * position;\n"
+         << "  surface_position = world_position.xyz;\n"
+         << "  surface_normal = worldNormal();\n"
+         << "  gl_FrontColor = lightVertex( surface_position, surface_normal );\n"
+         << "  back_colour = lightVertex( surface_position, -surface_normal );\n"
+         << "  for( int i = 0; i < " << count << "; i++ )\n"
+         << "    gl_TexCoord[i] = projector_matrices[i] * world_position;\n"
+         << "  gl_Position = world_view_proj * position;\n"
+         << "}\n";
+  return source.str();
+}
+
+// Raw bayer images are demosaiced at the pixel nearest to uv: every colour a pixel lacks is the
+// average of its neighbours of that colour. Neighbours are mirrored at the image edges, which keeps
+// their colour. Pixels are sampled at their centres, where the linear filter returns them unchanged,
+// and the texture has no mipmaps, so sampling it in a branch is fine.
+const char* BAYER_SOURCE =
+  "float fetchBayer( sampler2D image, vec2 pixel, vec2 offset, vec2 size )\n"
+  "{\n"
+  "  vec2 p = abs( pixel + offset );\n"
+  "  p = min( p, 2.0 * ( size - 1.0 ) - p );\n"
+  "  return texture2D( image, ( p + 0.5 ) / size ).r;\n"
+  "}\n"
+  "\n"
+  "// bayer.xy is the texture size, bayer.zw the red pixel of every 2x2 block; bayer.x is 0 for other images\n"
+  "vec4 sampleProjector( sampler2D image, vec2 uv, vec4 bayer )\n"
+  "{\n"
+  "  if( bayer.x <= 0.0 )\n"
+  "    return texture2D( image, uv );\n"
+  "\n"
+  "  vec2 size = bayer.xy;\n"
+  "  vec2 pixel = clamp( floor( uv * size ), vec2( 0.0 ), size - 1.0 );\n"
+  "  float centre = fetchBayer( image, pixel, vec2( 0.0, 0.0 ), size );\n"
+  "  float horizontal = ( fetchBayer( image, pixel, vec2( -1.0, 0.0 ), size ) + fetchBayer( image, pixel, vec2( 1.0, 0.0 ), size )) * 0.5;\n"
+  "  float vertical = ( fetchBayer( image, pixel, vec2( 0.0, -1.0 ), size ) + fetchBayer( image, pixel, vec2( 0.0, 1.0 ), size )) * 0.5;\n"
+  "  float diagonal = ( fetchBayer( image, pixel, vec2( -1.0, -1.0 ), size ) + fetchBayer( image, pixel, vec2( 1.0, -1.0 ), size ) +\n"
+  "                     fetchBayer( image, pixel, vec2( -1.0, 1.0 ), size ) + fetchBayer( image, pixel, vec2( 1.0, 1.0 ), size )) * 0.25;\n"
+  "\n"
+  "  // 0 on the columns and rows of the red pixels, 1 on those of the blue ones\n"
+  "  vec2 site = mod( pixel + bayer.zw, 2.0 );\n"
+  "  vec3 colour;\n"
+  "  if( site.x < 0.5 && site.y < 0.5 )\n"
+  "    colour = vec3( centre, ( horizontal + vertical ) * 0.5, diagonal );\n"
+  "  else if( site.x > 0.5 && site.y > 0.5 )\n"
+  "    colour = vec3( diagonal, ( horizontal + vertical ) * 0.5, centre );\n"
+  "  else if( site.y < 0.5 )\n"
+  "    colour = vec3( horizontal, centre, vertical );\n"
+  "  else\n"
+  "    colour = vec3( vertical, centre, horizontal );\n"
+  "  return vec4( colour, 1.0 );\n"
+  "}\n"
+  "\n";
+
+// Every projector is sampled, and the image with the most pixels per meter on the surface wins:
+// focal length * cos(incidence) / distance. The mesh is drawn without culling and its normals may
+// face either way, so the incidence is taken unsigned. Behind a projector w is negative and the
+// image would be mirrored, outside of [0,1] it would be repeated, transparent pixels are border.
+// The winner is composited over the lit surface the same way the former second, alpha blended
+// pass did over the first one, so the result against the background is unchanged.
+std::string getProjectorFragmentSource( size_t count )
+{
+  std::stringstream source;
+  for( size_t i = 0; i < count; i++ )
+    source << "uniform sampler2D projector_texture" << i << ";\n";
+  source << "// xyz is the projector position, w the focal length in pixels, 0 while it has no image\n"
+         << "uniform vec4 projector_positions[" << count << "];\n"
+         << "uniform vec4 projector_bayer[" << count << "];\n"
+         << "uniform float image_alpha;\n"
+         << "varying vec3 surface_position;\n"
+         << "varying vec3 surface_normal;\n"
+         << "varying vec4 back_colour;\n"
+         << "\n"
+         << BAYER_SOURCE
+         << "void main()\n"
+         << "{\n"
+         << "  vec4 surface = gl_FrontFacing ? gl_Color : back_colour;\n"
+         << "  vec3 normal = normalize( surface_normal );\n"
+         << "  vec4 image = vec4( 0.0 );\n"
+         << "  float best_score = 0.0;\n";
+  // unrolled, samplers can only be indexed by constants; sampled outside of the branches, mipmap
+  // selection needs the neighbouring fragments
+  for( size_t i = 0; i < count; i++ )
+  {
+    source << "  {\n"
+           << "    vec4 coordinates = gl_TexCoord[" << i << "];\n"
+           << "    vec2 uv = coordinates.xy / coordinates.w;\n"
+           << "    vec4 texel = sampleProjector( projector_texture" << i << ", uv, projector_bayer[" << i << "] );\n"
+           << "    vec3 to_projector = projector_positions[" << i << "].xyz - surface_position;\n"
+           << "    float score = projector_positions[" << i << "].w * abs( dot( normal, normalize( to_projector ))) / length( to_projector );\n"
+           << "    if( coordinates.w > 0.0 && uv == clamp( uv, 0.0, 1.0 ) && texel.a > 0.0 && score > best_score )\n"
+           << "    {\n"
+           << "      best_score = score;\n"
+           << "      image = texel;\n"
+           << "    }\n"
+           << "  }\n";
+  }
+  source << "\n"
+         << "  float weight = image.a * image_alpha;\n"
+         << "  float alpha = surface.a + weight - surface.a * weight;\n"
+         << "  vec3 colour = surface.rgb * surface.a * ( 1.0 - weight ) + image.rgb * weight;\n"
+         << "  gl_FragColor = vec4( alpha > 0.0 ? colour / alpha : surface.rgb, alpha );\n"
+         << "}\n";
+  return source.str();
+}
+
+void setLightingParameters( const Ogre::GpuProgramParametersSharedPtr& params )
+{
+  params->setNamedAutoConstant( "inverse_transpose_world", Ogre::GpuProgramParameters::ACT_INVERSE_TRANSPOSE_WORLD_MATRIX );
+  params->setNamedAutoConstant( "camera_position", Ogre::GpuProgramParameters::ACT_CAMERA_POSITION );
+  params->setNamedAutoConstant( "light_position", Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 0 );
+  params->setNamedAutoConstant( "light_diffuse", Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 0 );
+  params->setNamedAutoConstant( "light_specular", Ogre::GpuProgramParameters::ACT_LIGHT_SPECULAR_COLOUR, 0 );
+  params->setNamedAutoConstant( "ambient", Ogre::GpuProgramParameters::ACT_DERIVED_AMBIENT_LIGHT_COLOUR );
+  params->setNamedAutoConstant( "surface_diffuse", Ogre::GpuProgramParameters::ACT_SURFACE_DIFFUSE_COLOUR );
+  params->setNamedAutoConstant( "surface_specular", Ogre::GpuProgramParameters::ACT_SURFACE_SPECULAR_COLOUR );
+  params->setNamedAutoConstant( "surface_emissive", Ogre::GpuProgramParameters::ACT_SURFACE_EMISSIVE_COLOUR );
+  params->setNamedAutoConstant( "shininess", Ogre::GpuProgramParameters::ACT_SURFACE_SHININESS );
+}
+
+Ogre::HighLevelGpuProgramPtr createProgram( const std::string& name, const std::string& source, bool compact )
+{
+  Ogre::HighLevelGpuProgramPtr program = Ogre::HighLevelGpuProgramManager::getSingleton().createProgram(
+      name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, "glsl", Ogre::GPT_VERTEX_PROGRAM );
+  program->setSource(( compact ? DECODE_SOURCE : FLOAT_DECODE_SOURCE ) + source );
+  program->load();
+
+  Ogre::GpuProgramParametersSharedPtr params = program->getDefaultParameters();
+  params->setNamedAutoConstant( "world_view_proj", Ogre::GpuProgramParameters::ACT_WORLDVIEWPROJ_MATRIX );
+  params->setNamedAutoConstant( "world", Ogre::GpuProgramParameters::ACT_WORLD_MATRIX );
+  if( compact )
+  {
+    params->setNamedAutoConstant( "quantize_offset", Ogre::GpuProgramParameters::ACT_CUSTOM, QUANTIZE_OFFSET_PARAMETER );
+    params->setNamedAutoConstant( "quantize_scale", Ogre::GpuProgramParameters::ACT_CUSTOM, QUANTIZE_SCALE_PARAMETER );
+  }
+  return program;
+}
+
+} // namespace
+
+bool isCompactVertexProgramSupported()
+{
+  return Ogre::HighLevelGpuProgramManager::getSingleton().isLanguageSupported( "glsl" );
+}
+
+bool isLightingProgramSupported()
+{
+  return Ogre::HighLevelGpuProgramManager::getSingleton().isLanguageSupported( "glsl" );
+}
+
+std::string getLightingVertexProgram( bool compact )
+{
+  std::string name = compact ? "MeshDisplayCustom/CompactLightingVP" : "MeshDisplayCustom/LightingVP";
+  if( Ogre::HighLevelGpuProgramManager::getSingleton().resourceExists( name ))
+    return name;
+
+  Ogre::HighLevelGpuProgramPtr program = createProgram( name, std::string( LIGHTING_SOURCE ) + LIGHTING_MAIN_SOURCE, compact );
+  setLightingParameters( program->getDefaultParameters() );
+  return name;
+}
+
+std::string getLightingFragmentProgram()
+{
+  const std::string name = "MeshDisplayCustom/TwoSidedFP";
+  if( Ogre::HighLevelGpuProgramManager::getSingleton().resourceExists( name ))
+    return name;
+
+  Ogre::HighLevelGpuProgramPtr program = Ogre::HighLevelGpuProgramManager::getSingleton().createProgram(
+      name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, "glsl", Ogre::GPT_FRAGMENT_PROGRAM );
+  program->setSource( TWO_SIDED_FRAGMENT_SOURCE );
+  program->load();
+  return name;
+}
+
+bool isProjectorProgramSupported()
+{
+  return Ogre::HighLevelGpuProgramManager::getSingleton().isLanguageSupported( "glsl" );
+}
+
+std::string getProjectorVertexProgram( bool compact, size_t count )
+{
+  std::stringstream name;
+  name << "MeshDisplayCustom/" << ( compact ? "Compact" : "" ) << "ProjectorVP" << count;
+  if( Ogre::HighLevelGpuProgramManager::getSingleton().resourceExists( name.str() ))
+    return name.str();
+
+  Ogre::HighLevelGpuProgramPtr program = createProgram( name.str(), LIGHTING_SOURCE + getProjectorMainSource( count ), compact );
+  setLightingParameters( program->getDefaultParameters() );
+  return name.str();
+}
+
+std::string getProjectorFragmentProgram( size_t count )
+{
+  std::stringstream name;
+  name << "MeshDisplayCustom/ProjectorFP" << count;
+  if( Ogre::HighLevelGpuProgramManager::getSingleton().resourceExists( name.str() ))
+    return name.str();
+
+  Ogre::HighLevelGpuProgramPtr program = Ogre::HighLevelGpuProgramManager::getSingleton().createProgram(
+      name.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, "glsl", Ogre::GPT_FRAGMENT_PROGRAM );
+  program->setSource( getProjectorFragmentSource( count ));
+  program->load();
+
+  // projector i samples texture unit i
+  Ogre::GpuProgramParametersSharedPtr params = program->getDefaultParameters();
+  for( size_t i = 0; i < count; i++ )
+  {
+    std::stringstream sampler;
+    sampler << "projector_texture" << i;
+    params->setNamedConstant( sampler.str(), (int)i );
+  }
+  params->setNamedConstant( "image_alpha", 1.0f );
+  return name.str();
+}
+
+} // namespace rviz
@@ -0,0 +1,95 @@
+/*
+ * Mesh material programs.
+ *
+ * GLSL programs that decode the quantized mesh vertex layout and project camera images.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_COMPACT_VERTEX_PROGRAM_H
+#define RVIZ_COMPACT_VERTEX_PROGRAM_H
+
+#include <string>
+
+namespace rviz
+{
+
+// custom parameters of every MeshRenderable that undo the position quantization:
+// position = offset + quantized * scale
+const size_t QUANTIZE_OFFSET_PARAMETER = 0;
+const size_t QUANTIZE_SCALE_PARAMETER = 1;
+
+// the compact layout can only be drawn if GLSL vertex programs are available
+bool isCompactVertexProgramSupported();
+
+// shared vertices have a single normal for both sides, they are only lit two-sided with GLSL
+bool isLightingProgramSupported();
+
+/**
+ * Name of the vertex program replacing the fixed function lighting of the mesh material for the
+ * compact or the float vertex layout (ambient, emissive and one light with Blinn specular, like
+ * the fixed pipeline). Front and back faces are lit separately, the fragment program of
+ * getLightingFragmentProgram() picks the side that is visible. Created on first use.
+ */
+std::string getLightingVertexProgram( bool compact );
+std::string getLightingFragmentProgram();
+
+// the single pass projector material needs GLSL vertex and fragment programs
+bool isProjectorProgramSupported();
+
+// number of cameras the projector programs can blend, one texture unit each
+const size_t MAX_PROJECTORS = 4;
+
+/**
+ * Name of the vertex program of the single pass projector material for count projectors, for the
+ * compact or the float vertex layout. It lights the mesh like getLightingVertexProgram() and
+ * passes the world position transformed by "projector_matrices[i]" as texture coordinate i; the
+ * constants have to be updated with the projector frustums.
+ */
+std::string getProjectorVertexProgram( bool compact, size_t count );
+
+/**
+ * Name of the fragment program of the single pass projector material for count projectors. Per
+ * fragment it picks the image of texture unit i that sees the surface at the highest resolution,
+ * using the "projector_positions[i]" constants (position and focal length in pixels, 0 to disable),
+ * and blends it over the lit surface with the "image_alpha" constant. Only images in front of
+ * their projector are used, which replaces the back projection filter textures. Raw bayer images
+ * are debayered as they are sampled, given "projector_bayer[i]" (texture size and red pixel, see
+ * ProjectorTexture::getBayerRed(), all 0 for other images).
+ */
+std::string getProjectorFragmentProgram( size_t count );
+
+} // namespace rviz
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ * ImageDecodePool class implementation.
+ *
+ * Decodes compressed camera images for MeshDisplayCustom on a bounded set of worker threads.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <ros/ros.h>
+#include <sensor_msgs/image_encodings.h>
+#include <cv_bridge/cv_bridge.h>
+#include <opencv2/highgui/highgui.hpp>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+
+#include "image_decode_pool.h"
+
+namespace rviz
+{
+
+ImageDecodePool::ImageDecodePool( const Callback& callback, size_t num_threads )
+  : callback_( callback )
+  , delivered_( 0 )
+  , dropped_( 0 )
+  , generation_( 0 )
+  , running_( true )
+{
+  if( num_threads == 0 )
+  {
+    // leave a core for the render thread
+    size_t cores = boost::thread::hardware_concurrency();
+    num_threads = std::min<size_t>( std::max<size_t>( cores, 2 ) - 1, 4 );
+  }
+  max_queue_size_ = num_threads;
+
+  for( size_t i = 0; i < num_threads; i++ )
+    threads_.create_thread( boost::bind( &ImageDecodePool::run, this ));
+}
+
+ImageDecodePool::~ImageDecodePool()
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    running_ = false;
+  }
+  condition_.notify_all();
+  threads_.join_all();
+}
+
+void ImageDecodePool::addMessage( const sensor_msgs::CompressedImage::ConstPtr& msg )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    if( queue_.size() >= max_queue_size_ )
+    {
+      queue_.pop_front();
+      dropped_++;
+    }
+    queue_.push_back( msg );
+  }
+  condition_.notify_one();
+}
+
+void ImageDecodePool::clear()
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  queue_.clear();
+  last_delivered_stamp_ = ros::Time();
+  generation_++;
+}
+
+void ImageDecodePool::getStatistics( unsigned int& delivered, unsigned int& dropped )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  delivered = delivered_;
+  dropped = dropped_;
+  delivered_ = 0;
+  dropped_ = 0;
+}
+
+void ImageDecodePool::run()
+{
+  while( true )
+  {
+    sensor_msgs::CompressedImage::ConstPtr msg;
+    unsigned int generation;
+    {
+      boost::mutex::scoped_lock lock( mutex_ );
+      while( running_ && queue_.empty() )
+        condition_.wait( lock );
+      if( !running_ )
+        return;
+
+      msg = queue_.front();
+      queue_.pop_front();
+      generation = generation_;
+    }
+
+    sensor_msgs::Image::Ptr image = decode( *msg );
+    if( !image )
+      continue;
+
+    // delivery is serialized so that a slower worker can't hand over an older frame last
+    boost::mutex::scoped_lock delivery_lock( delivery_mutex_ );
+    bool stale;
+    {
+      boost::mutex::scoped_lock lock( mutex_ );
+      stale = generation != generation_ || image->header.stamp < last_delivered_stamp_;
+      if( stale )
+      {
+        dropped_++;
+      }
+      else
+      {
+        last_delivered_stamp_ = image->header.stamp;
+        delivered_++;
+      }
+    }
+
+    if( !stale )
+      callback_( image );
+  }
+}
+
+sensor_msgs::Image::Ptr ImageDecodePool::decode( const sensor_msgs::CompressedImage& msg )
+{
+  namespace enc = sensor_msgs::image_encodings;
+
+  cv_bridge::CvImage cv_image;
+  try
+  {
+    cv_image.image = cv::imdecode( cv::Mat( msg.data ), CV_LOAD_IMAGE_UNCHANGED );
+  }
+  catch( cv::Exception& e )
+  {
+    ROS_ERROR( "ImageDecodePool: failed to decode %s image: %s", msg.format.c_str(), e.what() );
+    return sensor_msgs::Image::Ptr();
+  }
+
+  if( cv_image.image.empty() )
+  {
+    ROS_ERROR( "ImageDecodePool: failed to decode %s image", msg.format.c_str() );
+    return sensor_msgs::Image::Ptr();
+  }
+
+  // imdecode returns color images in BGR(A) order
+  switch( cv_image.image.type() )
+  {
+  case CV_8UC1:  cv_image.encoding = enc::MONO8; break;
+  case CV_8UC3:  cv_image.encoding = enc::BGR8; break;
+  case CV_8UC4:  cv_image.encoding = enc::BGRA8; break;
+  case CV_16UC1: cv_image.encoding = enc::MONO16; break;
+  default:
+    ROS_ERROR( "ImageDecodePool: unsupported decoded image type %d", cv_image.image.type() );
+    return sensor_msgs::Image::Ptr();
+  }
+
+  cv_image.header = msg.header;
+  return cv_image.toImageMsg();
+}
+
+} // namespace rviz
@@ -0,0 +1,104 @@
+/*
+ * ImageDecodePool declaration.
+ *
+ * Decodes compressed camera images for MeshDisplayCustom on a bounded set of worker threads.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_IMAGE_DECODE_POOL_H
+#define RVIZ_IMAGE_DECODE_POOL_H
+
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <deque>
+
+namespace rviz
+{
+
+/**
+ * \class ImageDecodePool
+ * \brief Decodes compressed images in parallel and hands over only the newest result.
+ *
+ * At most one frame per worker waits in the queue; when it is full the oldest frame is dropped.
+ * A decoded frame is delivered only if its stamp is newer than the last delivered one, so frames
+ * that finish out of order are dropped instead of making the image jump back in time. The
+ * callback runs on the worker thread.
+ */
+class ImageDecodePool
+{
+public:
+  typedef boost::function<void ( const sensor_msgs::Image::ConstPtr& )> Callback;
+
+  ImageDecodePool( const Callback& callback, size_t num_threads = 0 );
+  ~ImageDecodePool();
+
+  void addMessage( const sensor_msgs::CompressedImage::ConstPtr& msg );
+
+  // drops queued frames and forgets the last delivered stamp
+  void clear();
+
+  // number of frames delivered and dropped since the last call
+  void getStatistics( unsigned int& delivered, unsigned int& dropped );
+
+  static sensor_msgs::Image::Ptr decode( const sensor_msgs::CompressedImage& msg );
+
+private:
+  void run();
+
+  Callback callback_;
+
+  boost::thread_group threads_;
+  boost::mutex mutex_;
+  boost::mutex delivery_mutex_;
+  boost::condition_variable condition_;
+
+  std::deque<sensor_msgs::CompressedImage::ConstPtr> queue_;
+  size_t max_queue_size_;
+  ros::Time last_delivered_stamp_;
+  unsigned int delivered_;
+  unsigned int dropped_;
+  unsigned int generation_;
+  bool running_;
+};
+
+} // namespace rviz
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * MeshBuffer declaration.
+ *
+ * Render-ready mesh data produced by MeshBuilder.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_MESH_BUFFER_H
+#define RVIZ_MESH_BUFFER_H
+
+#include <OGRE/OgreAxisAlignedBox.h>
+#include <OGRE/OgreVector3.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+namespace rviz
+{
+
+/**
+ * \struct MeshChunk
+ * \brief Spatial cell of a mesh: a contiguous range of MeshBuffer::indices and its bounds.
+ */
+struct MeshChunk
+{
+  MeshChunk()
+    : index_start( 0 )
+    , index_count( 0 )
+  {}
+
+  size_t index_start;
+  size_t index_count;
+  Ogre::AxisAlignedBox bounds;
+};
+
+/**
+ * \struct MeshBuffer
+ * \brief Packed vertex and index arrays ready to be copied into hardware buffers.
+ *
+ * Indices are kept as 32 bit values here and narrowed to 16 bit while they are copied into the
+ * hardware buffer whenever the vertex count allows it.
+ */
+struct MeshBuffer
+{
+  MeshBuffer()
+    : vertex_count( 0 )
+    , compact( false )
+    , quantize_offset( Ogre::Vector3::ZERO )
+    , quantize_scale( Ogre::Vector3::ZERO )
+    , invalid_triangles( 0 )
+    , indexed( true )
+    , triangle_count( 0 )
+    , topology_hash( 0 )
+    , vertices_only( false )
+    , lod_only( false )
+  {}
+
+  // interleaved x,y,z,nx,ny,nz
+  static const size_t FLOATS_PER_VERTEX = 6;
+
+  std::vector<float> vertices;
+  size_t vertex_count;
+
+  // compact layout: x,y,z,1 quantized to the bounds and an octahedral normal, 16 bit each
+  static const size_t SHORTS_PER_COMPACT_VERTEX = 6;
+
+  // when set, compact_vertices is uploaded instead of vertices; positions are decoded as
+  // quantize_offset + quantized * quantize_scale
+  bool compact;
+  std::vector<int16_t> compact_vertices;
+  Ogre::Vector3 quantize_offset;
+  Ogre::Vector3 quantize_scale;
+
+  std::vector<uint32_t> indices;
+
+  // triangles sorted into spatial cells, empty for a single chunk
+  std::vector<MeshChunk> chunks;
+
+  // simplified versions of indices, coarsest last; they reference the same vertices
+  std::vector<std::vector<uint32_t> > lod_indices;
+  // [level][chunk] (first, count) ranges of lod_indices sorted into the same chunks
+  std::vector<std::vector<std::pair<size_t, size_t> > > lod_chunk_ranges;
+
+  Ogre::AxisAlignedBox bounds;
+
+  // triangles dropped because they referenced vertices out of range
+  size_t invalid_triangles;
+
+  // layout and topology of the source mesh, used to detect vertex-only changes
+  bool indexed;
+  size_t triangle_count;
+  uint64_t topology_hash;
+
+  // set when the index buffer is unchanged from the previous buffer and only the
+  // vertex ranges [first, first+count) listed in dirty_ranges need to be rewritten
+  bool vertices_only;
+  std::vector<std::pair<size_t, size_t> > dirty_ranges;
+
+  // set when only lod_indices are new, the vertices and full resolution indices are already uploaded
+  bool lod_only;
+
+  bool uses32BitIndices() const { return vertex_count > 65535; }
+  size_t getIndexCount() const { return indices.size(); }
+};
+
+typedef boost::shared_ptr<MeshBuffer> MeshBufferPtr;
+typedef boost::shared_ptr<const MeshBuffer> MeshBufferConstPtr;
+
+} // namespace rviz
+
+#endif
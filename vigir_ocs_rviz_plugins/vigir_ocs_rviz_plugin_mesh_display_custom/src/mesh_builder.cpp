@@ -0,0 +1,1146 @@
+/*
+ * MeshBuilder class implementation.
+ *
+ * Converts shape_msgs::Mesh messages into MeshBuffers on a worker thread.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <OGRE/OgreVector3.h>
+
+#include <ros/console.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "mesh_builder.h"
+#include "mesh_hash.h"
+#include "mesh_simplifier.h"
+#include "mesh_snapshot.h"
+#include "parallel_for.h"
+#include "vertex_layout.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+uint64_t hashTriangles( const std::vector<shape_msgs::MeshTriangle>& triangles, uint64_t seed = 0 )
+{
+  if( triangles.empty() )
+    return hashBytes( NULL, 0, seed );
+
+  // the generated message is just the index array, so the vector can be hashed in one go
+  if( sizeof(shape_msgs::MeshTriangle) == 3*sizeof(uint32_t) )
+    return hashBytes( &triangles[0], triangles.size() * sizeof(shape_msgs::MeshTriangle), seed );
+
+  std::vector<uint32_t> indices( triangles.size()*3 );
+  for( size_t i = 0; i < triangles.size(); i++ )
+    std::copy( triangles[i].vertex_indices.begin(), triangles[i].vertex_indices.end(), indices.begin() + i*3 );
+  return hashBytes( &indices[0], indices.size() * sizeof(uint32_t), seed );
+}
+
+uint64_t hashVertices( const std::vector<geometry_msgs::Point>& points, uint64_t seed )
+{
+  if( points.empty() )
+    return hashBytes( NULL, 0, seed );
+
+  if( sizeof(geometry_msgs::Point) == 3*sizeof(double) )
+    return hashBytes( &points[0], points.size() * sizeof(geometry_msgs::Point), seed );
+
+  std::vector<double> coordinates( points.size()*3 );
+  for( size_t i = 0; i < points.size(); i++ )
+  {
+    coordinates[i*3] = points[i].x;
+    coordinates[i*3+1] = points[i].y;
+    coordinates[i*3+2] = points[i].z;
+  }
+  return hashBytes( &coordinates[0], coordinates.size() * sizeof(double), seed );
+}
+
+// dirty ranges closer than this many vertices are merged into one write
+const size_t DIRTY_RANGE_GAP = 64;
+
+// smaller meshes are cheap enough to always draw at full resolution
+const size_t LOD_MIN_TRIANGLES = 2048;
+// every level keeps a quarter of the triangles of the previous one, down to this floor
+const size_t LOD_REDUCTION = 4;
+const size_t LOD_MAX_LEVELS = 3;
+const size_t LOD_MIN_LEVEL_TRIANGLES = 512;
+
+// meshes are split into spatial chunks of roughly this many triangles
+const size_t CHUNK_TRIANGLES = 16384;
+
+// minimum time between two snapshot writes, in seconds
+const long SNAPSHOT_INTERVAL = 10;
+
+// sorts the triangles of indices by key into contiguous ranges, returns (first, count) per key
+void sortTriangles( std::vector<uint32_t>& indices, const std::vector<uint32_t>& keys, size_t key_count,
+                    std::vector<std::pair<size_t, size_t> >& ranges )
+{
+  ranges.assign( key_count, std::make_pair( 0, 0 ));
+  for( size_t t = 0; t < keys.size(); t++ )
+    ranges[keys[t]].second += 3;
+
+  std::vector<size_t> next( key_count );
+  size_t first = 0;
+  for( size_t k = 0; k < key_count; k++ )
+  {
+    ranges[k].first = first;
+    next[k] = first;
+    first += ranges[k].second;
+  }
+
+  std::vector<uint32_t> sorted( indices.size() );
+  for( size_t t = 0; t < keys.size(); t++ )
+  {
+    std::copy( indices.begin() + t*3, indices.begin() + t*3 + 3, sorted.begin() + next[keys[t]] );
+    next[keys[t]] += 3;
+  }
+  indices.swap( sorted );
+}
+
+// vertex and triangle loops are split over all cores once they have at least this many elements
+const size_t PARALLEL_MIN_RANGE = 32768;
+
+// merges per-range bounds computed by parallel loops
+Ogre::AxisAlignedBox mergeBounds( const std::vector<Ogre::AxisAlignedBox>& bounds )
+{
+  Ogre::AxisAlignedBox merged;
+  for( size_t r = 0; r < bounds.size(); r++ )
+    merged.merge( bounds[r] );
+  return merged;
+}
+
+// converts points to float positions with zero normals
+void convertVertices( const geometry_msgs::Point* points, float* vertices, Ogre::AxisAlignedBox* bounds,
+                      size_t range, size_t begin, size_t end )
+{
+  const size_t stride = MeshBuffer::FLOATS_PER_VERTEX;
+  Ogre::AxisAlignedBox range_bounds;
+  float* v = vertices + begin*stride;
+  for( size_t i = begin; i < end; i++, v += stride )
+  {
+    v[0] = points[i].x;
+    v[1] = points[i].y;
+    v[2] = points[i].z;
+    v[3] = v[4] = v[5] = 0.0f;
+    range_bounds.merge( Ogre::Vector3( v[0], v[1], v[2] ));
+  }
+  bounds[range] = range_bounds;
+}
+
+inline bool isValidTriangle( const boost::array<uint32_t, 3>& tri, size_t vertex_count )
+{
+  return tri[0] < vertex_count && tri[1] < vertex_count && tri[2] < vertex_count;
+}
+
+void countValidTriangles( const shape_msgs::MeshTriangle* triangles, size_t vertex_count, size_t* counts,
+                          size_t range, size_t begin, size_t end )
+{
+  size_t count = 0;
+  for( size_t i = begin; i < end; i++ )
+    count += isValidTriangle( triangles[i].vertex_indices, vertex_count ) ? 1 : 0;
+  counts[range] = count;
+}
+
+// counts the valid triangles per range and turns the counts into the first output triangle of
+// every range, so the ranges can write their output independently; returns the total
+size_t getValidTriangleOffsets( const std::vector<shape_msgs::MeshTriangle>& triangles, size_t vertex_count,
+                                size_t num_ranges, std::vector<size_t>& offsets )
+{
+  offsets.assign( num_ranges, 0 );
+  if( triangles.empty() )
+    return 0;
+  parallelFor( triangles.size(), num_ranges,
+               boost::bind( &countValidTriangles, &triangles[0], vertex_count, &offsets[0], _1, _2, _3 ));
+
+  size_t total = 0;
+  for( size_t r = 0; r < num_ranges; r++ )
+  {
+    size_t count = offsets[r];
+    offsets[r] = total;
+    total += count;
+  }
+  return total;
+}
+
+// copies the valid triangles to indices and computes their area-weighted face normals
+void writeIndexedTriangles( const shape_msgs::MeshTriangle* triangles, const float* vertices, size_t vertex_count,
+                            const size_t* offsets, uint32_t* indices, Ogre::Vector3* face_normals,
+                            size_t range, size_t begin, size_t end )
+{
+  const size_t stride = MeshBuffer::FLOATS_PER_VERTEX;
+  size_t t = offsets[range];
+  for( size_t i = begin; i < end; i++ )
+  {
+    const boost::array<uint32_t, 3>& tri = triangles[i].vertex_indices;
+    if( !isValidTriangle( tri, vertex_count ))
+      continue;
+
+    const float* v0 = vertices + tri[0]*stride;
+    const float* v1 = vertices + tri[1]*stride;
+    const float* v2 = vertices + tri[2]*stride;
+    Ogre::Vector3 p0( v0[0], v0[1], v0[2] );
+    // not normalized, so larger faces weigh more on the vertex normal
+    face_normals[t] = ( Ogre::Vector3( v1[0], v1[1], v1[2] ) - p0 ).crossProduct( Ogre::Vector3( v2[0], v2[1], v2[2] ) - p0 );
+    indices[t*3] = tri[0];
+    indices[t*3+1] = tri[1];
+    indices[t*3+2] = tri[2];
+    t++;
+  }
+}
+
+// vertex to triangle adjacency in compressed rows: the triangles around vertex v are
+// triangles[offsets[v]] to triangles[offsets[v+1]-1], in index order
+void buildVertexTriangles( const std::vector<uint32_t>& indices, size_t vertex_count,
+                           std::vector<size_t>& offsets, std::vector<uint32_t>& triangles )
+{
+  offsets.assign( vertex_count + 1, 0 );
+  for( size_t i = 0; i < indices.size(); i++ )
+    offsets[indices[i] + 1]++;
+  for( size_t v = 0; v < vertex_count; v++ )
+    offsets[v+1] += offsets[v];
+
+  std::vector<size_t> next( offsets.begin(), offsets.end() - 1 );
+  triangles.resize( indices.size() );
+  for( size_t i = 0; i < indices.size(); i++ )
+    triangles[next[indices[i]]++] = i / 3;
+}
+
+// sums the face normals around the vertices [begin, end) from the adjacency, so every range only
+// reads the faces of its own vertices and ranges never touch the same normal. Faces are flipped to
+// agree with the sum so far, so inconsistent winding doesn't cancel the normal out; the mesh is
+// lit on both sides, the direction of the normal doesn't matter.
+void accumulateVertexNormals( const size_t* offsets, const uint32_t* triangles, const Ogre::Vector3* face_normals, float* vertices,
+                              size_t, size_t begin, size_t end )
+{
+  const size_t stride = MeshBuffer::FLOATS_PER_VERTEX;
+  for( size_t v = begin; v < end; v++ )
+  {
+    Ogre::Vector3 sum( Ogre::Vector3::ZERO );
+    for( size_t k = offsets[v]; k < offsets[v+1]; k++ )
+    {
+      const Ogre::Vector3& normal = face_normals[triangles[k]];
+      sum += sum.dotProduct( normal ) < 0.0f ? -normal : normal;
+    }
+    sum.normalise();
+
+    float* n = vertices + v*stride + 3;
+    n[0] = sum.x;
+    n[1] = sum.y;
+    n[2] = sum.z;
+  }
+}
+
+// writes a front and a back face with the flat face normal for every valid triangle
+void writeExpandedTriangles( const shape_msgs::MeshTriangle* triangles, const geometry_msgs::Point* points, size_t vertex_count,
+                             const size_t* offsets, float* vertices, Ogre::AxisAlignedBox* bounds,
+                             size_t range, size_t begin, size_t end )
+{
+  const size_t stride = MeshBuffer::FLOATS_PER_VERTEX;
+  const FloatVertexLayout::Params params;
+  Ogre::AxisAlignedBox range_bounds;
+  float* out = vertices + offsets[range]*6*stride;
+  for( size_t i = begin; i < end; i++ )
+  {
+    const boost::array<uint32_t, 3>& tri = triangles[i].vertex_indices;
+    if( !isValidTriangle( tri, vertex_count ))
+      continue;
+
+    Ogre::Vector3 corners[3];
+    for( size_t c = 0; c < 3; c++ )
+    {
+      corners[c] = Ogre::Vector3( points[tri[c]].x, points[tri[c]].y, points[tri[c]].z );
+      range_bounds.merge( corners[c] );
+    }
+    Ogre::Vector3 normal = ( corners[1] - corners[0] ).crossProduct( corners[2] - corners[0] );
+    normal.normalise();
+    const Ogre::Vector3 back_normal = -normal;
+
+    for( size_t c = 0; c < 3; c++, out += stride )
+      FloatVertexLayout::write( out, &corners[c].x, &normal.x, params );
+    // reversed winding for the back face
+    for( size_t c = 0; c < 3; c++, out += stride )
+      FloatVertexLayout::write( out, &corners[2-c].x, &back_normal.x, params );
+  }
+  bounds[range] = range_bounds;
+}
+
+// Simplifies the triangles of every chunk in [begin, end) on its own, to a quarter of their
+// count. Vertices shared with other chunks are locked, so a chunk meets its neighbours at every
+// level and only references its own vertices, which keeps the levels inside the chunk bounds.
+// Chunks are copied to local vertex indices, so the simplifier only allocates for their vertices.
+void simplifyChunks( const float* vertices, const std::vector<uint32_t>* indices, const std::pair<size_t, size_t>* ranges,
+                     const std::vector<bool>* shared, std::vector<uint32_t>* results, size_t, size_t begin, size_t end )
+{
+  const size_t stride = MeshBuffer::FLOATS_PER_VERTEX;
+  for( size_t c = begin; c < end; c++ )
+  {
+    results[c].clear();
+    if( ranges[c].second == 0 )
+      continue;
+
+    std::vector<uint32_t>::const_iterator first = indices->begin() + ranges[c].first;
+    std::vector<uint32_t>::const_iterator last = first + ranges[c].second;
+    std::vector<uint32_t> chunk_vertices( first, last );
+    std::sort( chunk_vertices.begin(), chunk_vertices.end() );
+    chunk_vertices.erase( std::unique( chunk_vertices.begin(), chunk_vertices.end() ), chunk_vertices.end() );
+
+    std::vector<float> positions( chunk_vertices.size() * 3 );
+    std::vector<bool> locked( chunk_vertices.size(), false );
+    for( size_t i = 0; i < chunk_vertices.size(); i++ )
+    {
+      std::copy( vertices + chunk_vertices[i]*stride, vertices + chunk_vertices[i]*stride + 3, positions.begin() + i*3 );
+      locked[i] = !shared->empty() && (*shared)[chunk_vertices[i]];
+    }
+
+    std::vector<uint32_t> local( first, last );
+    for( size_t i = 0; i < local.size(); i++ )
+      local[i] = std::lower_bound( chunk_vertices.begin(), chunk_vertices.end(), local[i] ) - chunk_vertices.begin();
+
+    simplifyMesh( &positions[0], 3, chunk_vertices.size(), local, local.size() / 3 / LOD_REDUCTION, locked, results[c] );
+    for( size_t i = 0; i < results[c].size(); i++ )
+      results[c][i] = chunk_vertices[results[c][i]];
+  }
+}
+
+bool sameTopology( const MeshBuffer& a, const MeshBuffer& b )
+{
+  return a.indexed == b.indexed &&
+         a.compact == b.compact &&
+         a.vertex_count == b.vertex_count &&
+         a.triangle_count == b.triangle_count &&
+         a.topology_hash == b.topology_hash &&
+         a.getIndexCount() == b.getIndexCount();
+}
+
+} // namespace
+
+MeshBuilder::MeshBuilder()
+  : indexed_( true )
+  , compact_( false )
+  , lod_enabled_( true )
+  , running_( true )
+  , generation_( 0 )
+  , snapshot_dirty_( false )
+  , next_snapshot_time_( boost::get_system_time() )
+{
+  thread_ = boost::thread( boost::bind( &MeshBuilder::run, this ) );
+}
+
+MeshBuilder::~MeshBuilder()
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    running_ = false;
+  }
+  condition_.notify_all();
+  thread_.join();
+
+  // the last buffers may still be within the snapshot interval
+  if( snapshot_dirty_ )
+    writeSnapshot();
+}
+
+bool MeshBuilder::addMesh( const std::string& id, const shape_msgs::Mesh::ConstPtr& mesh, const std::string& cache_path )
+{
+  // hashed before locking, so the builder thread is never held up by it
+  uint64_t fingerprint = MeshBuilder::fingerprint( *mesh );
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    std::map<std::string, uint64_t>::iterator last = fingerprints_.find( id );
+    if( last != fingerprints_.end() && last->second == fingerprint )
+      return false;
+    fingerprints_[id] = fingerprint;
+    queue( id, mesh, cache_path );
+  }
+  condition_.notify_all();
+  return true;
+}
+
+bool MeshBuilder::addBuffer( const std::string& id, const MeshBufferPtr& buffer, uint64_t fingerprint, const std::string& cache_path )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    std::map<std::string, uint64_t>::iterator last = fingerprints_.find( id );
+    if( last != fingerprints_.end() && last->second == fingerprint )
+      return false;
+    fingerprints_[id] = fingerprint;
+    queue( id, shape_msgs::Mesh::ConstPtr(), cache_path );
+    pending_buffers_[id] = buffer;
+  }
+  condition_.notify_all();
+  return true;
+}
+
+void MeshBuilder::removeMesh( const std::string& id )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    fingerprints_.erase( id );
+    queue( id, shape_msgs::Mesh::ConstPtr() );
+  }
+  condition_.notify_all();
+}
+
+uint64_t MeshBuilder::fingerprint( const shape_msgs::Mesh& mesh )
+{
+  return hashVertices( mesh.vertices, hashTriangles( mesh.triangles, mesh.vertices.size() ));
+}
+
+void MeshBuilder::queue( const std::string& id, const shape_msgs::Mesh::ConstPtr& mesh, const std::string& cache_path )
+{
+  if( pending_meshes_.find( id ) == pending_meshes_.end() )
+    queue_.push_back( id );
+  pending_meshes_[id] = mesh;
+  pending_buffers_.erase( id );
+  if( cache_path.empty() )
+    cache_paths_.erase( id );
+  else
+    cache_paths_[id] = cache_path;
+}
+
+void MeshBuilder::requeueAll()
+{
+  std::map<std::string, shape_msgs::Mesh::ConstPtr>::const_iterator it;
+  for( it = last_meshes_.begin(); it != last_meshes_.end(); ++it )
+  {
+    if( pending_meshes_.find( it->first ) == pending_meshes_.end() )
+      queue( it->first, it->second );
+  }
+}
+
+void MeshBuilder::setIndexed( bool indexed )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    if( indexed_ == indexed )
+      return;
+    indexed_ = indexed;
+    requeueAll();
+  }
+  condition_.notify_all();
+}
+
+void MeshBuilder::setCompact( bool compact )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    if( compact_ == compact )
+      return;
+    compact_ = compact;
+    requeueAll();
+  }
+  condition_.notify_all();
+}
+
+void MeshBuilder::setLodEnabled( bool enabled )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    if( lod_enabled_ == enabled )
+      return;
+    lod_enabled_ = enabled;
+    // force full uploads, a vertex-only update would keep the levels that are displayed
+    current_buffers_.clear();
+    requeueAll();
+  }
+  condition_.notify_all();
+}
+
+void MeshBuilder::takeResults( std::map<std::string, MeshBufferPtr>& results )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  results.clear();
+  results.swap( results_ );
+
+  std::map<std::string, MeshBufferPtr>::const_iterator it;
+  for( it = results.begin(); it != results.end(); ++it )
+  {
+    if( !it->second )
+      current_buffers_.erase( it->first );
+    else if( !it->second->lod_only )
+      current_buffers_[it->first] = it->second;
+  }
+  if( !results.empty() )
+    snapshot_dirty_ = true;
+}
+
+void MeshBuilder::clear()
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  queue_.clear();
+  pending_meshes_.clear();
+  pending_buffers_.clear();
+  cache_paths_.clear();
+  fingerprints_.clear();
+  last_meshes_.clear();
+  results_.clear();
+  current_buffers_.clear();
+  generation_++;
+}
+
+void MeshBuilder::restoreMesh( const std::string& id, const MeshBufferPtr& buffer, uint64_t fingerprint )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    // live data that arrived before the snapshot was read wins
+    if( last_meshes_.find( id ) != last_meshes_.end() || pending_meshes_.find( id ) != pending_meshes_.end() )
+      return;
+
+    // queued like a mesh, the worker recovers the source mesh and builds the levels of detail
+    fingerprints_[id] = fingerprint;
+    queue( id, shape_msgs::Mesh::ConstPtr() );
+    pending_buffers_[id] = buffer;
+  }
+  condition_.notify_all();
+}
+
+void MeshBuilder::setSnapshotPath( const std::string& path )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    snapshot_path_ = path;
+  }
+  condition_.notify_all();
+}
+
+void MeshBuilder::writeSnapshot()
+{
+  std::string path;
+  std::map<std::string, MeshBufferConstPtr> buffers;
+  std::map<std::string, uint64_t> fingerprints;
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    path = snapshot_path_;
+    buffers = current_buffers_;
+    fingerprints = fingerprints_;
+    snapshot_dirty_ = false;
+    next_snapshot_time_ = boost::get_system_time() + boost::posix_time::seconds( SNAPSHOT_INTERVAL );
+  }
+
+  // buffers are never modified once the render thread has taken them, so they are written unlocked
+  if( !path.empty() && !writeMeshSnapshot( path, buffers, fingerprints ))
+    ROS_WARN( "MeshBuilder: cannot write snapshot %s", path.c_str() );
+}
+
+void MeshBuilder::run()
+{
+  while( true )
+  {
+    std::string id;
+    shape_msgs::Mesh::ConstPtr mesh;
+    MeshBufferPtr restored;
+    MeshBufferConstPtr base;
+    std::string cache_path;
+    uint64_t fingerprint = 0;
+    bool indexed;
+    bool compact;
+    bool lod_enabled;
+    unsigned int generation;
+    {
+      boost::mutex::scoped_lock lock( mutex_ );
+      while( running_ && queue_.empty() )
+      {
+        bool snapshot_pending = snapshot_dirty_ && !snapshot_path_.empty();
+        if( snapshot_pending && boost::get_system_time() >= next_snapshot_time_ )
+        {
+          // only written while idle, so it never holds up a build
+          lock.unlock();
+          writeSnapshot();
+          lock.lock();
+        }
+        else if( snapshot_pending )
+        {
+          condition_.timed_wait( lock, next_snapshot_time_ );
+        }
+        else
+        {
+          condition_.wait( lock );
+        }
+      }
+      if( !running_ )
+        return;
+
+      id = queue_.front();
+      queue_.pop_front();
+      mesh = pending_meshes_[id];
+      pending_meshes_.erase( id );
+      std::map<std::string, MeshBufferPtr>::iterator pending_buffer = pending_buffers_.find( id );
+      if( pending_buffer != pending_buffers_.end() )
+      {
+        restored = pending_buffer->second;
+        pending_buffers_.erase( pending_buffer );
+      }
+      std::map<std::string, std::string>::iterator cache = cache_paths_.find( id );
+      if( cache != cache_paths_.end() )
+      {
+        cache_path = cache->second;
+        cache_paths_.erase( cache );
+      }
+
+      if( !mesh && !restored )
+      {
+        // removals keep their place in the queue, so a block built earlier can't come back
+        last_meshes_.erase( id );
+        results_[id].reset();
+        continue;
+      }
+
+      indexed = indexed_;
+      compact = compact_;
+      lod_enabled = lod_enabled_;
+      generation = generation_;
+      std::map<std::string, uint64_t>::const_iterator last = fingerprints_.find( id );
+      if( last != fingerprints_.end() )
+        fingerprint = last->second;
+      std::map<std::string, MeshBufferConstPtr>::const_iterator current = current_buffers_.find( id );
+      if( current != current_buffers_.end() )
+        base = current->second;
+    }
+
+    bool built = !restored;
+    MeshBufferPtr buffer = restored;
+    try
+    {
+      // a restored block keeps its buffer unless the layout changed since, but still needs its
+      // source mesh for later rebuilds
+      if( restored )
+      {
+        shape_msgs::Mesh::Ptr extracted( new shape_msgs::Mesh() );
+        extractMesh( *restored, *extracted );
+        mesh = extracted;
+        if( restored->indexed != indexed || restored->compact != compact )
+        {
+          restored.reset();
+        }
+        else if( !lod_enabled )
+        {
+          restored->lod_indices.clear();
+          restored->lod_chunk_ranges.clear();
+        }
+      }
+
+      built = !restored;
+      buffer = restored;
+      if( built )
+      {
+        buffer.reset( new MeshBuffer() );
+        if( indexed )
+          buildIndexed( *mesh, *buffer );
+        else
+          buildExpanded( *mesh, *buffer );
+        buffer->indexed = indexed;
+        buffer->compact = compact;
+        buffer->triangle_count = mesh->triangles.size();
+        buffer->topology_hash = hashTriangles( mesh->triangles );
+
+        // a vertex-only update keeps the chunk layout, so the uploaded indices stay valid
+        if( base && findDirtyRanges( *base, *buffer ))
+        {
+          buffer->indices = base->indices;
+          buffer->chunks = base->chunks;
+          updateChunkBounds( *buffer );
+        }
+        else
+        {
+          buildChunks( *buffer );
+        }
+
+        if( compact )
+        {
+          buildCompact( *buffer, buffer->vertices_only ? base.get() : NULL );
+
+          // requantized positions all change, so the vertex-only path can't be used
+          if( buffer->vertices_only && ( buffer->quantize_offset != base->quantize_offset ||
+                                         buffer->quantize_scale != base->quantize_scale ))
+          {
+            buffer->vertices_only = false;
+            buffer->dirty_ranges.clear();
+          }
+        }
+      }
+    }
+    catch( const std::exception& e )
+    {
+      dropBlock( id, generation, e );
+      continue;
+    }
+
+    bool build_lods;
+    {
+      boost::mutex::scoped_lock lock( mutex_ );
+      if( generation != generation_ )
+        continue;
+
+      // the render thread picked up another buffer while we were diffing against base
+      std::map<std::string, MeshBufferConstPtr>::const_iterator current = current_buffers_.find( id );
+      if( buffer->vertices_only && ( current == current_buffers_.end() || current->second != base ))
+      {
+        buffer->vertices_only = false;
+        buffer->dirty_ranges.clear();
+      }
+
+      // keep a reference instead of a copy, so the mesh can be rebuilt when the layout changes
+      last_meshes_[id] = mesh;
+      results_[id] = buffer;
+
+      // vertex-only updates keep the levels that were built for this topology, restored buffers
+      // may bring their own
+      build_lods = lod_enabled && indexed && !buffer->vertices_only && buffer->lod_indices.empty() &&
+                   buffer->triangle_count >= LOD_MIN_TRIANGLES;
+    }
+
+    // the full resolution mesh is already on its way, the simplified levels follow when ready
+    std::vector<std::vector<uint32_t> > lod_indices;
+    std::vector<std::vector<std::pair<size_t, size_t> > > lod_chunk_ranges;
+    try
+    {
+      if( build_lods && !buildLods( id, *buffer, lod_indices, lod_chunk_ranges ))
+        continue;
+
+      // written before the levels are attached to the buffer, the render thread may be reading it
+      if( !cache_path.empty() && ( built || !lod_indices.empty() ) &&
+          !writeMeshSnapshot( cache_path, id, *buffer, fingerprint, lod_indices, lod_chunk_ranges ))
+      {
+        ROS_WARN( "MeshBuilder: cannot write mesh cache %s", cache_path.c_str() );
+      }
+    }
+    catch( const std::exception& e )
+    {
+      // the full resolution buffer is already handed out, only its levels are lost
+      reportError( id, e );
+      continue;
+    }
+
+    if( lod_indices.empty() )
+      continue;
+
+    boost::mutex::scoped_lock lock( mutex_ );
+    if( generation != generation_ )
+      continue;
+
+    std::map<std::string, MeshBufferPtr>::iterator result = results_.find( id );
+    std::map<std::string, MeshBufferConstPtr>::iterator current = current_buffers_.find( id );
+    if( result != results_.end() )
+    {
+      // not picked up yet, hand the levels over together with the pending buffer
+      if( result->second && !result->second->lod_only && sameTopology( *result->second, *buffer ))
+      {
+        result->second->lod_indices.swap( lod_indices );
+        result->second->lod_chunk_ranges.swap( lod_chunk_ranges );
+        updateChunkBounds( *result->second );
+      }
+    }
+    else if( current != current_buffers_.end() && sameTopology( *current->second, *buffer ))
+    {
+      MeshBufferPtr lods( new MeshBuffer() );
+      lods->indexed = buffer->indexed;
+      lods->vertex_count = buffer->vertex_count;
+      lods->triangle_count = buffer->triangle_count;
+      lods->topology_hash = buffer->topology_hash;
+      lods->lod_only = true;
+      lods->lod_indices.swap( lod_indices );
+      lods->lod_chunk_ranges.swap( lod_chunk_ranges );
+      results_[id] = lods;
+    }
+  }
+}
+
+void MeshBuilder::dropBlock( const std::string& id, unsigned int generation, const std::exception& error )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    // the block keeps the buffer it had; the fingerprint is forgotten, so the same mesh is built
+    // again when it is republished
+    if( generation == generation_ && !pending_meshes_.count( id ))
+      fingerprints_.erase( id );
+  }
+  reportError( id, error );
+}
+
+void MeshBuilder::reportError( const std::string& id, const std::exception& error )
+{
+  std::string message = "Mesh " + id + " was dropped: " + error.what();
+  ROS_ERROR( "MeshBuilder: %s", message.c_str() );
+  boost::mutex::scoped_lock lock( mutex_ );
+  error_ = message;
+}
+
+bool MeshBuilder::takeError( std::string& message )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  if( error_.empty() )
+    return false;
+  message.swap( error_ );
+  error_.clear();
+  return true;
+}
+
+bool MeshBuilder::buildLods( const std::string& id, const MeshBuffer& buffer, std::vector<std::vector<uint32_t> >& lod_indices,
+                             std::vector<std::vector<std::pair<size_t, size_t> > >& lod_chunk_ranges )
+{
+  // every chunk picks its own level, so chunks are simplified separately; meshes that aren't
+  // split are one chunk
+  std::vector<std::pair<size_t, size_t> > ranges;
+  for( size_t c = 0; c < buffer.chunks.size(); c++ )
+    ranges.push_back( std::make_pair( buffer.chunks[c].index_start, buffer.chunks[c].index_count ));
+  if( ranges.empty() )
+    ranges.push_back( std::make_pair( 0, buffer.indices.size() ));
+
+  // vertices used by more than one chunk stay where they are on every level
+  std::vector<bool> shared;
+  if( ranges.size() > 1 )
+  {
+    const uint32_t NO_CHUNK = (uint32_t)-1;
+    std::vector<uint32_t> vertex_chunk( buffer.vertex_count, NO_CHUNK );
+    shared.assign( buffer.vertex_count, false );
+    for( size_t c = 0; c < ranges.size(); c++ )
+    {
+      for( size_t i = ranges[c].first; i < ranges[c].first + ranges[c].second; i++ )
+      {
+        uint32_t v = buffer.indices[i];
+        if( vertex_chunk[v] == NO_CHUNK )
+          vertex_chunk[v] = c;
+        else if( vertex_chunk[v] != c )
+          shared[v] = true;
+      }
+    }
+  }
+
+  lod_indices.reserve( LOD_MAX_LEVELS );
+  lod_chunk_ranges.reserve( LOD_MAX_LEVELS );
+  const std::vector<uint32_t>* source = &buffer.indices;
+  size_t target = buffer.indices.size() / 3 / LOD_REDUCTION;
+  while( lod_indices.size() < LOD_MAX_LEVELS && target >= LOD_MIN_LEVEL_TRIANGLES )
+  {
+    {
+      // a newer mesh replaces this block anyway
+      boost::mutex::scoped_lock lock( mutex_ );
+      if( pending_meshes_.count( id ) || !running_ )
+        return false;
+    }
+
+    // every level is simplified from the previous one, which is cheaper and keeps them nested
+    std::vector<std::vector<uint32_t> > chunk_levels( ranges.size() );
+    parallelFor( ranges.size(), getParallelRangeCount( ranges.size(), 1 ),
+                 boost::bind( &simplifyChunks, &buffer.vertices[0], source, &ranges[0], &shared, &chunk_levels[0], _1, _2, _3 ));
+
+    std::vector<uint32_t> level;
+    std::vector<std::pair<size_t, size_t> > level_ranges( ranges.size() );
+    for( size_t c = 0; c < chunk_levels.size(); c++ )
+    {
+      level_ranges[c] = std::make_pair( level.size(), chunk_levels[c].size() );
+      level.insert( level.end(), chunk_levels[c].begin(), chunk_levels[c].end() );
+    }
+    if( level.size() >= source->size() )
+      break; // nothing left to collapse
+
+    lod_indices.push_back( std::vector<uint32_t>() );
+    lod_indices.back().swap( level );
+    lod_chunk_ranges.push_back( level_ranges );
+    source = &lod_indices.back();
+    ranges = level_ranges;
+    target /= LOD_REDUCTION;
+  }
+
+  // a mesh without chunks draws each level as a whole
+  if( buffer.chunks.empty() )
+    lod_chunk_ranges.clear();
+  return true;
+}
+
+void MeshBuilder::buildChunks( MeshBuffer& buffer )
+{
+  buffer.chunks.clear();
+
+  size_t triangle_count = buffer.indices.size() / 3;
+  if( triangle_count <= CHUNK_TRIANGLES || !buffer.bounds.isFinite() )
+    return;
+
+  // meshes are surfaces, so size the cells from the area spanned by the two largest extents
+  Ogre::Vector3 origin = buffer.bounds.getMinimum();
+  Ogre::Vector3 size = buffer.bounds.getSize();
+  Ogre::Real extents[3] = { size.x, size.y, size.z };
+  std::sort( extents, extents + 3 );
+  Ogre::Real area = extents[2] * std::max( extents[1], extents[2] * 0.01f );
+  Ogre::Real cell_size = sqrt( area / ( triangle_count / CHUNK_TRIANGLES + 1 ));
+  if( cell_size <= 0.0f )
+    return;
+
+  size_t cells[3];
+  for( int a = 0; a < 3; a++ )
+    cells[a] = std::max<size_t>( 1, ceil( size[a] / cell_size ));
+  if( cells[0] * cells[1] * cells[2] == 1 )
+    return;
+
+  const size_t stride = MeshBuffer::FLOATS_PER_VERTEX;
+  std::vector<uint32_t> keys( triangle_count );
+  for( size_t t = 0; t < triangle_count; t++ )
+  {
+    Ogre::Vector3 centroid( 0.0f, 0.0f, 0.0f );
+    for( size_t c = 0; c < 3; c++ )
+    {
+      const float* v = &buffer.vertices[buffer.indices[t*3+c]*stride];
+      centroid += Ogre::Vector3( v[0], v[1], v[2] );
+    }
+    centroid = centroid / 3.0f - origin;
+
+    size_t cell[3];
+    for( int a = 0; a < 3; a++ )
+      cell[a] = std::min<size_t>( cells[a]-1, std::max( centroid[a], 0.0f ) / cell_size );
+    keys[t] = ( cell[2] * cells[1] + cell[1] ) * cells[0] + cell[0];
+  }
+
+  std::vector<std::pair<size_t, size_t> > ranges;
+  sortTriangles( buffer.indices, keys, cells[0] * cells[1] * cells[2], ranges );
+
+  for( size_t i = 0; i < ranges.size(); i++ )
+  {
+    if( ranges[i].second == 0 )
+      continue;
+    MeshChunk chunk;
+    chunk.index_start = ranges[i].first;
+    chunk.index_count = ranges[i].second;
+    buffer.chunks.push_back( chunk );
+  }
+  updateChunkBounds( buffer );
+}
+
+void MeshBuilder::updateChunkBounds( MeshBuffer& buffer )
+{
+  const size_t stride = MeshBuffer::FLOATS_PER_VERTEX;
+  for( size_t c = 0; c < buffer.chunks.size(); c++ )
+  {
+    MeshChunk& chunk = buffer.chunks[c];
+    chunk.bounds.setNull();
+    for( size_t i = chunk.index_start; i < chunk.index_start + chunk.index_count; i++ )
+    {
+      const float* v = &buffer.vertices[buffer.indices[i]*stride];
+      chunk.bounds.merge( Ogre::Vector3( v[0], v[1], v[2] ));
+    }
+
+    // the chunk is culled with these bounds whichever level it draws
+    for( size_t level = 0; level < buffer.lod_chunk_ranges.size(); level++ )
+    {
+      if( c >= buffer.lod_chunk_ranges[level].size() )
+        continue;
+      const std::pair<size_t, size_t>& range = buffer.lod_chunk_ranges[level][c];
+      for( size_t i = range.first; i < range.first + range.second; i++ )
+      {
+        const float* v = &buffer.vertices[buffer.lod_indices[level][i]*stride];
+        chunk.bounds.merge( Ogre::Vector3( v[0], v[1], v[2] ));
+      }
+    }
+  }
+}
+
+void MeshBuilder::buildIndexed( const shape_msgs::Mesh& mesh, MeshBuffer& buffer )
+{
+  const std::vector<geometry_msgs::Point>& points = mesh.vertices;
+  const std::vector<shape_msgs::MeshTriangle>& triangles = mesh.triangles;
+
+  // one vertex per mesh vertex, normals are accumulated from the faces that share it
+  buffer.vertex_count = points.size();
+  buffer.vertices.resize( points.size()*MeshBuffer::FLOATS_PER_VERTEX );
+  buffer.bounds.setNull();
+  if( !points.empty() )
+  {
+    std::vector<Ogre::AxisAlignedBox> bounds( getParallelRangeCount( points.size(), PARALLEL_MIN_RANGE ));
+    parallelFor( points.size(), bounds.size(),
+                 boost::bind( &convertVertices, &points[0], &buffer.vertices[0], &bounds[0], _1, _2, _3 ));
+    buffer.bounds = mergeBounds( bounds );
+  }
+
+  std::vector<size_t> offsets;
+  size_t num_ranges = getParallelRangeCount( triangles.size(), PARALLEL_MIN_RANGE );
+  size_t valid_triangles = getValidTriangleOffsets( triangles, points.size(), num_ranges, offsets );
+  buffer.invalid_triangles = triangles.size() - valid_triangles;
+  buffer.indices.resize( valid_triangles*3 );
+  if( valid_triangles == 0 )
+  {
+    // without faces there is nothing to accumulate, the normals stay zero
+    return;
+  }
+
+  std::vector<Ogre::Vector3> face_normals( valid_triangles );
+  parallelFor( triangles.size(), num_ranges,
+               boost::bind( &writeIndexedTriangles, &triangles[0], &buffer.vertices[0], points.size(), &offsets[0],
+                            &buffer.indices[0], &face_normals[0], _1, _2, _3 ));
+
+  std::vector<size_t> vertex_offsets;
+  std::vector<uint32_t> vertex_triangles;
+  buildVertexTriangles( buffer.indices, points.size(), vertex_offsets, vertex_triangles );
+  parallelFor( points.size(), getParallelRangeCount( points.size(), PARALLEL_MIN_RANGE ),
+               boost::bind( &accumulateVertexNormals, &vertex_offsets[0], &vertex_triangles[0], &face_normals[0],
+                            &buffer.vertices[0], _1, _2, _3 ));
+}
+
+void MeshBuilder::buildExpanded( const shape_msgs::Mesh& mesh, MeshBuffer& buffer )
+{
+  const std::vector<geometry_msgs::Point>& points = mesh.vertices;
+  const std::vector<shape_msgs::MeshTriangle>& triangles = mesh.triangles;
+
+  // every triangle becomes a front and a back face with its own flat normal; valid triangles are
+  // counted first so every range knows where its output starts
+  std::vector<size_t> offsets;
+  size_t num_ranges = getParallelRangeCount( triangles.size(), PARALLEL_MIN_RANGE );
+  size_t valid_triangles = getValidTriangleOffsets( triangles, points.size(), num_ranges, offsets );
+  buffer.invalid_triangles = triangles.size() - valid_triangles;
+  buffer.vertex_count = valid_triangles * 6;
+  buffer.vertices.resize( buffer.vertex_count * MeshBuffer::FLOATS_PER_VERTEX );
+  buffer.bounds.setNull();
+  if( valid_triangles > 0 )
+  {
+    std::vector<Ogre::AxisAlignedBox> bounds( num_ranges );
+    parallelFor( triangles.size(), num_ranges,
+                 boost::bind( &writeExpandedTriangles, &triangles[0], &points[0], points.size(), &offsets[0],
+                              &buffer.vertices[0], &bounds[0], _1, _2, _3 ));
+    buffer.bounds = mergeBounds( bounds );
+  }
+
+  buffer.indices.resize( buffer.vertex_count );
+  for( size_t i = 0; i < buffer.indices.size(); i++ )
+    buffer.indices[i] = i;
+}
+
+void MeshBuilder::buildCompact( MeshBuffer& buffer, const MeshBuffer* reference )
+{
+  // deforming meshes keep the quantization of the previous buffer while they stay inside it
+  const Ogre::Real MAX_QUANTIZED = 32767.0f;
+  if( reference && reference->compact &&
+      Ogre::AxisAlignedBox( reference->quantize_offset - reference->quantize_scale * MAX_QUANTIZED,
+                            reference->quantize_offset + reference->quantize_scale * MAX_QUANTIZED ).contains( buffer.bounds ))
+  {
+    buffer.quantize_offset = reference->quantize_offset;
+    buffer.quantize_scale = reference->quantize_scale;
+  }
+  else if( buffer.bounds.isFinite() )
+  {
+    buffer.quantize_offset = buffer.bounds.getCenter();
+    buffer.quantize_scale = buffer.bounds.getHalfSize() / MAX_QUANTIZED;
+  }
+
+  CompactVertexLayout::Params params;
+  params.offset = buffer.quantize_offset;
+  for( int a = 0; a < 3; a++ )
+    params.inverse_scale[a] = buffer.quantize_scale[a] > 0.0f ? 1.0f / buffer.quantize_scale[a] : 0.0f;
+
+  buffer.compact_vertices.resize( buffer.vertex_count * MeshBuffer::SHORTS_PER_COMPACT_VERTEX );
+  if( buffer.vertex_count > 0 )
+    writeVertices<CompactVertexLayout>( &buffer.vertices[0], buffer.vertex_count, params, &buffer.compact_vertices[0] );
+}
+
+void MeshBuilder::extractMesh( const MeshBuffer& buffer, shape_msgs::Mesh& mesh )
+{
+  const size_t stride = MeshBuffer::FLOATS_PER_VERTEX;
+  mesh.vertices.clear();
+  mesh.triangles.clear();
+  if( buffer.indexed )
+  {
+    mesh.vertices.resize( buffer.vertex_count );
+    for( size_t i = 0; i < buffer.vertex_count; i++ )
+    {
+      mesh.vertices[i].x = buffer.vertices[i*stride];
+      mesh.vertices[i].y = buffer.vertices[i*stride+1];
+      mesh.vertices[i].z = buffer.vertices[i*stride+2];
+    }
+    mesh.triangles.resize( buffer.indices.size() / 3 );
+    for( size_t t = 0; t < mesh.triangles.size(); t++ )
+      std::copy( buffer.indices.begin() + t*3, buffer.indices.begin() + t*3 + 3, mesh.triangles[t].vertex_indices.begin() );
+    return;
+  }
+
+  // expanded buffers hold a front and a back face per triangle, the front face has the original winding
+  size_t triangle_count = buffer.vertex_count / 6;
+  mesh.vertices.resize( triangle_count * 3 );
+  mesh.triangles.resize( triangle_count );
+  for( size_t t = 0; t < triangle_count; t++ )
+  {
+    for( size_t c = 0; c < 3; c++ )
+    {
+      const float* v = &buffer.vertices[( t*6 + c )*stride];
+      mesh.vertices[t*3+c].x = v[0];
+      mesh.vertices[t*3+c].y = v[1];
+      mesh.vertices[t*3+c].z = v[2];
+      mesh.triangles[t].vertex_indices[c] = t*3 + c;
+    }
+  }
+}
+
+bool MeshBuilder::findDirtyRanges( const MeshBuffer& base, MeshBuffer& buffer )
+{
+  buffer.vertices_only = false;
+  buffer.dirty_ranges.clear();
+
+  if( !sameTopology( base, buffer ))
+    return false;
+
+  const size_t vertex_bytes = MeshBuffer::FLOATS_PER_VERTEX * sizeof(float);
+  const float* old_vertices = base.vertex_count ? &base.vertices[0] : NULL;
+  const float* new_vertices = buffer.vertex_count ? &buffer.vertices[0] : NULL;
+
+  size_t first = 0;
+  size_t count = 0;
+  for( size_t i = 0; i < buffer.vertex_count; i++ )
+  {
+    size_t offset = i * MeshBuffer::FLOATS_PER_VERTEX;
+    if( memcmp( old_vertices + offset, new_vertices + offset, vertex_bytes ) == 0 )
+      continue;
+
+    if( count > 0 && i - ( first + count ) <= DIRTY_RANGE_GAP )
+    {
+      count = i - first + 1;
+    }
+    else
+    {
+      if( count > 0 )
+        buffer.dirty_ranges.push_back( std::make_pair( first, count ));
+      first = i;
+      count = 1;
+    }
+  }
+  if( count > 0 )
+    buffer.dirty_ranges.push_back( std::make_pair( first, count ));
+
+  buffer.vertices_only = true;
+  return true;
+}
+
+} // namespace rviz
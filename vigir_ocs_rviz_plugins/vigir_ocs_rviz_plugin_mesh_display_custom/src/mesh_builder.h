@@ -0,0 +1,211 @@
+/*
+ * MeshBuilder declaration.
+ *
+ * Converts shape_msgs::Mesh messages into MeshBuffers on a worker thread.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_MESH_BUILDER_H
+#define RVIZ_MESH_BUILDER_H
+
+#include <shape_msgs/Mesh.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include <deque>
+#include <exception>
+#include <map>
+#include <string>
+
+#include "mesh_buffer.h"
+
+namespace rviz
+{
+
+/**
+ * \class MeshBuilder
+ * \brief Background stage that flattens incoming meshes into render-ready buffers.
+ *
+ * Meshes are keyed by a block id, so regions of a large mesh can be inserted, replaced and removed
+ * independently; a plain mesh is the block with an empty id. Only the newest mesh of every block is
+ * kept: if several messages arrive while a block is waiting, the intermediate ones are dropped.
+ * Blocks are built in the order they were queued. Finished buffers are picked up from the render
+ * thread with takeResults(), so nothing here touches Ogre resources.
+ *
+ * When a mesh has the same topology (vertex count, triangle count and index hash) as the buffer
+ * currently displayed, the result is flagged as a vertex-only update together with the vertex
+ * ranges that actually changed.
+ *
+ * Large indexed meshes additionally get simplified index sets for distance based level of detail.
+ * They are built after the full resolution buffer has been handed over, and delivered either with
+ * that buffer if it has not been picked up yet or as a separate lod_only result.
+ *
+ * Large meshes are split into spatial chunks by sorting their triangles into grid cells, so the
+ * render thread can cull every chunk separately.
+ *
+ * With a snapshot path set, the buffers handed to the render thread are written to disk whenever
+ * the builder is idle, at most every SNAPSHOT_INTERVAL seconds; restoreMesh() brings them back.
+ */
+class MeshBuilder
+{
+public:
+  MeshBuilder();
+  ~MeshBuilder();
+
+  // queue a block to be built, replacing any mesh of the same block that is still waiting;
+  // returns false and drops the mesh if it is identical to the last mesh queued for the block.
+  // With a cache path, the built buffer and its levels of detail are written there as a snapshot
+  bool addMesh( const std::string& id, const shape_msgs::Mesh::ConstPtr& mesh, const std::string& cache_path = std::string() );
+
+  // like addMesh(), but with a buffer built before from a mesh with the given fingerprint, e.g.
+  // read from a cache; it is rebuilt if the layout changed since and gets levels of detail if it
+  // has none, then written back to the cache path
+  bool addBuffer( const std::string& id, const MeshBufferPtr& buffer, uint64_t fingerprint,
+                  const std::string& cache_path = std::string() );
+
+  // queue the removal of a block, it is reported as an empty buffer by takeResults()
+  void removeMesh( const std::string& id );
+
+  // switch between shared vertices and expanded front/back faces, rebuilding all blocks
+  void setIndexed( bool indexed );
+
+  // switch between float vertices and the compact 16 bit layout, rebuilding all blocks
+  void setCompact( bool compact );
+
+  // enable/disable building simplified levels of detail, rebuilding all blocks
+  void setLodEnabled( bool enabled );
+
+  // moves the newest finished buffer of every block that changed since the last call into results;
+  // removed blocks map to an empty pointer
+  void takeResults( std::map<std::string, MeshBufferPtr>& results );
+
+  // returns the last error since the previous call, e.g. a block that ran out of memory while it
+  // was built and was dropped
+  bool takeError( std::string& message );
+
+  // forget all pending/last meshes and finished buffers
+  void clear();
+
+  // queues a buffer from a snapshot to be handed out as if it had just been built from a mesh with
+  // the given fingerprint, followed by its levels of detail; ignored if the block already has a
+  // mesh, rebuilt if the layout changed since
+  void restoreMesh( const std::string& id, const MeshBufferPtr& buffer, uint64_t fingerprint );
+
+  // where the displayed buffers are saved; an empty path disables snapshots
+  void setSnapshotPath( const std::string& path );
+
+  static void buildIndexed( const shape_msgs::Mesh& mesh, MeshBuffer& buffer );
+  static void buildExpanded( const shape_msgs::Mesh& mesh, MeshBuffer& buffer );
+
+  // content hash over the vertex coordinates and triangle indices
+  static uint64_t fingerprint( const shape_msgs::Mesh& mesh );
+
+  // fills in dirty_ranges/vertices_only if buffer only differs from base in its vertex data
+  static bool findDirtyRanges( const MeshBuffer& base, MeshBuffer& buffer );
+
+  // fills in the compact vertex layout; the quantization of reference is kept if it still covers the bounds
+  static void buildCompact( MeshBuffer& buffer, const MeshBuffer* reference );
+
+  // reorders the indices into grid cells of about CHUNK_TRIANGLES triangles and fills in chunks
+  static void buildChunks( MeshBuffer& buffer );
+  static void updateChunkBounds( MeshBuffer& buffer );
+
+  // recovers a source mesh from a full resolution buffer, so restored blocks can be rebuilt
+  static void extractMesh( const MeshBuffer& buffer, shape_msgs::Mesh& mesh );
+
+private:
+  void run();
+
+  // queues id unless it is already waiting, dropping a buffer that was waiting for it; must be
+  // called with mutex_ held
+  void queue( const std::string& id, const shape_msgs::Mesh::ConstPtr& mesh, const std::string& cache_path = std::string() );
+  // queues every block that is displayed again, e.g. after a layout change
+  void requeueAll();
+
+  // returns false if a newer mesh of the block is waiting; the levels are empty if there is
+  // nothing to simplify
+  bool buildLods( const std::string& id, const MeshBuffer& buffer, std::vector<std::vector<uint32_t> >& lod_indices,
+                  std::vector<std::vector<std::pair<size_t, size_t> > >& lod_chunk_ranges );
+
+  // saves current_buffers_ to snapshot_path_; must be called without mutex_ held
+  void writeSnapshot();
+
+  // a build failed, e.g. with bad_alloc on a huge or corrupt mesh; the block keeps its last buffer
+  // and the error is reported through takeError(). Must be called without mutex_ held
+  void dropBlock( const std::string& id, unsigned int generation, const std::exception& error );
+  void reportError( const std::string& id, const std::exception& error );
+
+  boost::thread thread_;
+  boost::mutex mutex_;
+  boost::condition_variable condition_;
+
+  // blocks waiting to be built in FIFO order; an empty mesh pointer removes the block
+  std::deque<std::string> queue_;
+  std::map<std::string, shape_msgs::Mesh::ConstPtr> pending_meshes_;
+  // restored or cached buffers waiting in the queue, their pending mesh is empty
+  std::map<std::string, MeshBufferPtr> pending_buffers_;
+  // where a waiting block is written once it is built
+  std::map<std::string, std::string> cache_paths_;
+
+  std::map<std::string, shape_msgs::Mesh::ConstPtr> last_meshes_;
+  // fingerprint of the last mesh queued per block, so republished meshes are dropped on arrival
+  std::map<std::string, uint64_t> fingerprints_;
+  std::map<std::string, MeshBufferPtr> results_;
+
+  // last buffers handed to the render thread, the reference for vertex-only updates
+  std::map<std::string, MeshBufferConstPtr> current_buffers_;
+
+  bool indexed_;
+  bool compact_;
+  bool lod_enabled_;
+  bool running_;
+
+  // bumped by clear() so that a build in flight is discarded
+  unsigned int generation_;
+
+  std::string error_;
+
+  std::string snapshot_path_;
+  // set when the render thread took buffers that are not in the snapshot yet
+  bool snapshot_dirty_;
+  boost::system_time next_snapshot_time_;
+};
+
+} // namespace rviz
+
+#endif
@@ -41,11 +41,19 @@
 #include <OGRE/OgreSceneManager.h>
 #include <OGRE/OgreMovableObject.h>
 #include <OGRE/OgreMaterialManager.h>
+#include <OGRE/OgreTechnique.h>
+#include <OGRE/OgrePass.h>
 #include <OGRE/OgreFrustum.h>
+#include <OGRE/OgreCamera.h>
+#include <OGRE/OgreViewport.h>
+#include <OGRE/OgreVector2.h>
+#include <OGRE/OgreVector4.h>
+#include <OGRE/OgreMatrix4.h>
 
 #include "rviz/display_context.h"
 #include "rviz/robot/robot.h"
 #include "rviz/robot/tf_link_updater.h"
+#include "rviz/properties/bool_property.h"
 #include "rviz/properties/color_property.h"
 #include "rviz/properties/vector_property.h"
 #include "rviz/properties/ros_topic_property.h"
@@ -54,30 +62,37 @@
 #include "rviz/properties/quaternion_property.h"
 #include "rviz/render_panel.h"
 #include "rviz/validate_floats.h"
+#include "rviz/view_controller.h"
 #include "rviz/view_manager.h"
 #include "rviz/visualization_manager.h"
 
 #include <image_transport/camera_common.h>
 
+#include <algorithm>
+
 #include <sensor_msgs/image_encodings.h>
 #include <cv_bridge/cv_bridge.h>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <opencv2/highgui/highgui.hpp>
 
 #include "mesh_display_custom.h"
+#include "camera_projector.h"
+#include "compact_vertex_program.h"
+#include "image_decode_pool.h"
+#include "mesh_builder.h"
+#include "mesh_file_loader.h"
+#include "mesh_geometry.h"
+#include "mesh_snapshot.h"
 
 namespace rviz
 {
 
-bool validateFloats(const sensor_msgs::CameraInfo& msg)
-{
-    bool valid = true;
-    valid = valid && validateFloats( msg.D );
-    valid = valid && validateFloats( msg.K );
-    valid = valid && validateFloats( msg.R );
-    valid = valid && validateFloats( msg.P );
-    return valid;
-}
+// block id of the mesh loaded from "Mesh File"; block ids on the topic are not expected to start with '#'
+static const std::string MESH_FILE_ID = "#mesh_file";
+
+// an image is only halved once it keeps this many times the pixels the mesh covers, so a coverage
+// close to a threshold doesn't switch the resolution back and forth
+static const float TEXTURE_DOWNSAMPLE_MARGIN = 1.25f;
 
 MeshDisplayCustom::MeshDisplayCustom()
     : ImageDisplayBase()
@@ -85,7 +100,14 @@ MeshDisplayCustom::MeshDisplayCustom()
     , mesh_node_(NULL)
     , projector_node_(NULL)
     , decal_frustum_(NULL)
-    , manual_object_(NULL)
+    , decal_tex_state_(NULL)
+    , compact_material_(false)
+    , projector_program_(false)
+    , mesh_builder_(new MeshBuilder())
+    , mesh_file_loader_(NULL)
+    , snapshot_restored_(false)
+    , decode_pool_(NULL)
+    , compressed_received_(0)
     , initialized_(false)
 {
     image_alpha_property_ = new FloatProperty( "Image Alpha", 1.0f,
@@ -96,6 +118,19 @@ MeshDisplayCustom::MeshDisplayCustom()
                                             "shape_msgs::Mesh topic to subscribe to.",
                                             this, SLOT( updateTopic() ));
 
+    mesh_block_topic_property_ = new RosTopicProperty( "Mesh Block Topic", "",
+                                                  QString::fromStdString( ros::message_traits::datatype<vigir_ocs_rviz_plugins::MeshBlock>() ),
+                                                  "vigir_ocs_rviz_plugins::MeshBlock topic with regions of the mesh that are added, replaced or deleted independently.",
+                                                  this, SLOT( updateTopic() ));
+
+    mesh_file_property_ = new StringProperty( "Mesh File", "",
+                                              "Binary PLY or STL file shown next to the meshes from the topics. Parsed files are cached in $ROS_HOME/mesh_cache by content hash.",
+                                              this, SLOT( updateMeshFile() ) );
+
+    extra_image_topics_property_ = new StringProperty( "Additional Image Topics", "",
+                                                       "Space separated image topics of more cameras projected onto the same mesh, using the transport of the image topic. Where cameras overlap, the one seeing the surface at the highest resolution is shown. Requires GLSL.",
+                                                       this, SLOT( updateTopic() ) );
+
     mesh_alpha_property_ = new FloatProperty( "Mesh Alpha", 0.6f,
                                               "Amount of transparency for the mesh.", this, SLOT( updateMeshProperties() ) );
 
@@ -108,6 +143,22 @@ MeshDisplayCustom::MeshDisplayCustom()
                                              this, SLOT( updateMeshProperties() ) );
     rotation_property_ = new QuaternionProperty("Projector Rotation", Ogre::Quaternion::IDENTITY,"rotation of the texture projector object",this,SLOT(updateMeshProperties()));
 
+    texture_lod_property_ = new BoolProperty( "Texture LOD", true,
+                                              "Downsample camera images before upload when the mesh only covers a small part of the screen.",
+                                              this );
+
+    indexed_geometry_property_ = new BoolProperty( "Indexed Geometry", true,
+                                                   "Upload the mesh vertices once with an index buffer instead of expanding every triangle into front and back faces.",
+                                                   this, SLOT( updateGeometryMode() ) );
+
+    mesh_lod_property_ = new BoolProperty( "Mesh LOD", true,
+                                           "Draw simplified versions of large indexed meshes when they are far from the camera.",
+                                           this, SLOT( updateMeshLod() ) );
+
+    compact_vertices_property_ = new BoolProperty( "Compact Vertices", false,
+                                                   "Store positions as 16 bit values quantized to the mesh bounds and normals octahedral encoded, halving GPU memory. Requires GLSL.",
+                                                   this, SLOT( updateVertexFormat() ) );
+
 }
 
 MeshDisplayCustom::~MeshDisplayCustom()
@@ -115,6 +166,14 @@ MeshDisplayCustom::~MeshDisplayCustom()
     unsubscribe();
     caminfo_tf_filter_->clear();
     delete caminfo_tf_filter_;
+
+    // the loader hands its meshes to the builder, so it has to go first
+    delete mesh_file_loader_;
+    delete mesh_builder_;
+    delete decode_pool_;
+
+    for(std::map<std::string, MeshGeometry*>::iterator it = mesh_geometries_.begin(); it != mesh_geometries_.end(); ++it)
+        delete it->second;
 }
 
 void MeshDisplayCustom::onInitialize()
@@ -129,6 +188,8 @@ void MeshDisplayCustom::onInitialize()
 
     caminfo_tf_filter_->connectInput(caminfo_sub_);
     caminfo_tf_filter_->registerCallback(boost::bind(&MeshDisplayCustom::caminfoCallback, this, _1));
+
+    updateGeometryMode();
 }
 
 void MeshDisplayCustom::createProjector()
@@ -152,11 +213,33 @@ void MeshDisplayCustom::addDecalToMaterial(const Ogre::String& matName)
 {
     Ogre::MaterialPtr mat = (Ogre::MaterialPtr)Ogre::MaterialManager::getSingleton().getByName(matName);
     mat->setCullingMode(Ogre::CULL_NONE);
-    Ogre::Pass* pass = mat->getTechnique(0)->createPass();
 
-    pass->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
-    pass->setDepthBias(1);
-    //pass->setLightingEnabled(true);
+    // with GLSL the projection and the back projection test run in the lit pass, which avoids
+    // drawing the mesh twice
+    projector_program_ = isProjectorProgramSupported();
+    Ogre::Pass* pass = mat->getTechnique(0)->getPass(0);
+    if(!projector_program_)
+    {
+        pass = mat->getTechnique(0)->createPass();
+        pass->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+        pass->setDepthBias(1);
+        //pass->setLightingEnabled(true);
+    }
+
+    Ogre::TextureUnitState* tex_state = createProjectorTextureUnit(pass, texture_.getTexture()->getName());
+    decal_tex_state_ = tex_state;
+
+    // the fixed function pass can't debayer, the images are then debayered before upload
+    texture_.setRawBayer(projector_program_);
+    if(projector_program_)
+    {
+        updateProjectorTextures();
+        return;
+    }
+
+    tex_state->setProjectiveTexturing(true, decal_frustum_);
+    tex_state->setColourOperation(Ogre::LBO_REPLACE); //don't accept additional effects
+    updateImageAlpha();
 
     // need the decal_filter to avoid back projection
     Ogre::String resource_group_name = "decal_textures_folder";
@@ -170,13 +253,6 @@ void MeshDisplayCustom::addDecalToMaterial(const Ogre::String& matName)
     // loads files into our resource manager
     resource_manager.loadResourceGroup(resource_group_name);
 
-    Ogre::TextureUnitState* tex_state = pass->createTextureUnitState();//"Decal.png");
-    tex_state->setTextureName(texture_.getTexture()->getName());
-    tex_state->setProjectiveTexturing(true, decal_frustum_);
-    tex_state->setTextureAddressingMode(Ogre::TextureUnitState::TAM_CLAMP);
-    tex_state->setTextureFiltering(Ogre::FO_POINT, Ogre::FO_LINEAR, Ogre::FO_NONE);
-    tex_state->setColourOperation(Ogre::LBO_REPLACE); //don't accept additional effects
-
     for(int i = 0; i < filter_frustum_.size(); i++)
     {
         tex_state = pass->createTextureUnitState("Decal_filter.png");
@@ -186,6 +262,69 @@ void MeshDisplayCustom::addDecalToMaterial(const Ogre::String& matName)
     }
 }
 
+Ogre::TextureUnitState* MeshDisplayCustom::createProjectorTextureUnit(Ogre::Pass* pass, const std::string& texture_name)
+{
+    Ogre::TextureUnitState* tex_state = pass->createTextureUnitState();//"Decal.png");
+    tex_state->setTextureName(texture_name);
+    // outside of the image the sampler returns a white, fully transparent border, so that the
+    // edge pixels are not replicated all over the mesh
+    tex_state->setTextureAddressingMode(Ogre::TextureUnitState::TAM_BORDER);
+    tex_state->setTextureBorderColour(Ogre::ColourValue(1.0f, 1.0f, 1.0f, 0.0f));
+    // trilinear, the projector texture is mipmapped for zoomed out views
+    tex_state->setTextureFiltering(Ogre::FO_LINEAR, Ogre::FO_LINEAR, Ogre::FO_LINEAR);
+    return tex_state;
+}
+
+void MeshDisplayCustom::updateExtraProjectors()
+{
+    for(size_t i = 0; i < extra_projectors_.size(); i++)
+    {
+        CameraProjector* projector = extra_projectors_[i];
+        QString status_name = QString::fromStdString("Image " + projector->getTopic());
+        try
+        {
+            if(projector->update())
+                setStatus(StatusProperty::Ok, status_name, "OK");
+            else
+                setStatus(StatusProperty::Warn, status_name, "No image, camera info or transform received");
+        }
+        catch( UnsupportedImageEncoding& e )
+        {
+            setStatus(StatusProperty::Error, status_name, e.what());
+        }
+    }
+
+    updateProjectorTextures();
+}
+
+void MeshDisplayCustom::updateProjectorTextures()
+{
+    if(!projector_program_ || decal_tex_state_ == NULL)
+        return;
+
+    // texture unit 0 projects the image topic, the additional cameras follow in order
+    Ogre::Pass* pass = mesh_material_->getTechnique(0)->getPass(0);
+    size_t count = 1 + extra_projectors_.size();
+    if(pass->getNumTextureUnitStates() != count)
+    {
+        while(pass->getNumTextureUnitStates() > count)
+            pass->removeTextureUnitState(pass->getNumTextureUnitStates() - 1);
+        while(pass->getNumTextureUnitStates() < count)
+            createProjectorTextureUnit(pass, "");
+        updateMaterialPrograms();
+    }
+
+    // every camera rotates through its own texture ring
+    for(size_t i = 0; i < extra_projectors_.size(); i++)
+    {
+        extra_projectors_[i]->getTexture().setRawBayer(true);
+        const Ogre::TexturePtr& texture = extra_projectors_[i]->getTexture().getTexture();
+        Ogre::TextureUnitState* tex_state = pass->getTextureUnitState(i + 1);
+        if(tex_state->getTextureName() != texture->getName())
+            tex_state->setTextureName(texture->getName());
+    }
+}
+
 void MeshDisplayCustom::setPose()
 {
     if(projector_node_ == NULL)
@@ -202,63 +341,291 @@ void MeshDisplayCustom::setPose()
 
 void MeshDisplayCustom::updateMesh( const shape_msgs::Mesh::ConstPtr& mesh )
 {
-    boost::mutex::scoped_lock lock( mesh_mutex_ );
+    // the mesh is flattened on the builder thread and picked up in update(); republished
+    // copies of the same mesh are recognized by their fingerprint and dropped right here
+    mesh_builder_->addMesh(std::string(), mesh);
+}
 
-    // create our scenenode and material
-    load();
+void MeshDisplayCustom::updateMeshBlock( const vigir_ocs_rviz_plugins::MeshBlock::ConstPtr& block )
+{
+    if(block->action == vigir_ocs_rviz_plugins::MeshBlock::DELETE)
+    {
+        mesh_builder_->removeMesh(block->id);
+        return;
+    }
 
-    // set properties
-    setPose();
+    // share the message instead of copying the mesh out of it
+    mesh_builder_->addMesh(block->id, shape_msgs::Mesh::ConstPtr(block, &block->mesh));
+}
 
-    if (!manual_object_)
+void MeshDisplayCustom::meshFileCallback( const shape_msgs::Mesh::ConstPtr& mesh, const std::string& cache_path )
+{
+    mesh_builder_->addMesh(MESH_FILE_ID, mesh, cache_path);
+}
+
+void MeshDisplayCustom::meshFileBufferCallback( const MeshBufferPtr& buffer, uint64_t fingerprint, const std::string& cache_path )
+{
+    mesh_builder_->addBuffer(MESH_FILE_ID, buffer, fingerprint, cache_path);
+}
+
+void MeshDisplayCustom::updateMeshFile()
+{
+    if(mesh_file_loader_ == NULL)
+        mesh_file_loader_ = new MeshFileLoader(boost::bind(&MeshDisplayCustom::meshFileCallback, this, _1, _2),
+                                               boost::bind(&MeshDisplayCustom::meshFileBufferCallback, this, _1, _2, _3));
+
+    // the previous file stays up until the new one is loaded
+    std::string path = mesh_file_property_->getStdString();
+    mesh_file_loader_->load(path);
+    if(path.empty())
+    {
+        mesh_builder_->removeMesh(MESH_FILE_ID);
+        deleteStatus( "Mesh File" );
+    }
+    else
     {
-        static uint32_t count = 0;
-        std::stringstream ss;
-        ss << "MeshObject" << count++;
-        manual_object_ = context_->getSceneManager()->createManualObject(ss.str());
-        mesh_node_->attachObject(manual_object_);
+        setStatus( StatusProperty::Warn, "Mesh File", QString::fromStdString( "Loading " + path ) );
     }
+}
 
-    // If we have the same number of tris as previously, just update the object
-    if (last_mesh_.vertices.size() > 0 && mesh->vertices.size()*2 == last_mesh_.vertices.size())
+void MeshDisplayCustom::updateMeshFileStatus()
+{
+    bool ok;
+    std::string message;
+    if(mesh_file_loader_ == NULL || !mesh_file_loader_->takeStatus(ok, message))
+        return;
+
+    if(ok)
     {
-        manual_object_->beginUpdate(0);
+        setStatus( StatusProperty::Ok, "Mesh File", QString::fromStdString( message ) );
     }
-    else // Otherwise clear it and begin anew
+    else
     {
-        manual_object_->clear();
-        manual_object_->estimateVertexCount(mesh->vertices.size()*2);
-        manual_object_->begin(mesh_material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST);
+        mesh_builder_->removeMesh(MESH_FILE_ID);
+        setStatus( StatusProperty::Error, "Mesh File", QString::fromStdString( message ) );
     }
+}
+
+std::string MeshDisplayCustom::getSnapshotName()
+{
+    return "mesh" + mesh_topic_property_->getStdString() + "+" + mesh_block_topic_property_->getStdString();
+}
+
+void MeshDisplayCustom::restoreSnapshot()
+{
+    snapshot_restored_ = true;
+
+    std::string path = getSnapshotPath(getSnapshotName());
+    mesh_builder_->setSnapshotPath(path);
+
+    std::map<std::string, MeshBufferPtr> buffers;
+    std::map<std::string, uint64_t> fingerprints;
+    if(path.empty() || !readMeshSnapshot(path, buffers, fingerprints))
+        return;
+
+    // shown until the publishers send something new; identical latched meshes are dropped by fingerprint
+    for(std::map<std::string, MeshBufferPtr>::const_iterator it = buffers.begin(); it != buffers.end(); ++it)
+        mesh_builder_->restoreMesh(it->first, it->second, fingerprints[it->first]);
 
-    const std::vector<geometry_msgs::Point>& points = mesh->vertices;
-    for(size_t i = 0; i < mesh->triangles.size(); i++)
+    std::stringstream ss;
+    ss << "Restored " << buffers.size() << " mesh blocks from " << path;
+    setStatus( StatusProperty::Ok, "Snapshot", QString::fromStdString( ss.str() ) );
+}
+
+void MeshDisplayCustom::updateGeometry()
+{
+    // replaced by the status of the next block that is built
+    std::string error;
+    if(mesh_builder_->takeError(error))
+        setStatus( StatusProperty::Error, "Mesh", QString::fromStdString( error ) );
+
+    std::map<std::string, MeshBufferPtr> buffers;
+    mesh_builder_->takeResults(buffers);
+    if(buffers.empty())
+        return;
+
+    boost::mutex::scoped_lock lock( mesh_mutex_ );
+
+    // create our scenenode and material
+    load();
+
+    // set properties
+    setPose();
+
+    size_t invalid_triangles = 0;
+    bool geometry_changed = false;
+    for(std::map<std::string, MeshBufferPtr>::const_iterator it = buffers.begin(); it != buffers.end(); ++it)
     {
-        // make sure we have front-face/back-face triangles
-        for(int side = 0; side < 2; side++)
+        std::map<std::string, MeshGeometry*>::iterator geometry = mesh_geometries_.find(it->first);
+        if(!it->second)
         {
-            std::vector<Ogre::Vector3> corners(3);
-            for(size_t c = 0; c < 3; c++)
+            // the block was deleted
+            if(geometry != mesh_geometries_.end())
             {
-                size_t corner = side ? 2-c : c; // order of corners if side == 1
-                corners[corner] = Ogre::Vector3(points[mesh->triangles[i].vertex_indices[corner]].x, points[mesh->triangles[i].vertex_indices[corner]].y, points[mesh->triangles[i].vertex_indices[corner]].z);
+                delete geometry->second;
+                mesh_geometries_.erase(geometry);
             }
-            Ogre::Vector3 normal = (corners[1] - corners[0]).crossProduct(corners[2] - corners[0]);
-            normal.normalise();
+            continue;
+        }
 
-            for(size_t c = 0; c < 3; c++)
+        if(geometry == mesh_geometries_.end())
+        {
+            MeshGeometry* mesh_geometry = new MeshGeometry(mesh_node_);
+            mesh_geometry->setMaterial(mesh_material_->getName());
+            geometry = mesh_geometries_.insert(std::make_pair(it->first, mesh_geometry)).first;
+        }
+
+        geometry->second->setGeometry(*it->second);
+        if(!it->second->lod_only)
+        {
+            if(it->second->compact != compact_material_)
             {
-                manual_object_->position(corners[c]);
-                manual_object_->normal(normal);
+                compact_material_ = it->second->compact;
+                updateMaterialPrograms();
             }
+
+            invalid_triangles += it->second->invalid_triangles;
+            geometry_changed = true;
         }
     }
 
-    manual_object_->end();
+    if(geometry_changed)
+    {
+        if(invalid_triangles > 0)
+        {
+            std::stringstream ss;
+            ss << invalid_triangles << " triangles with out of range vertex indices were skipped";
+            setStatus( StatusProperty::Warn, "Mesh", QString::fromStdString( ss.str() ) );
+        }
+        else
+        {
+            setStatus( StatusProperty::Ok, "Mesh", "OK" );
+        }
+    }
+
+    context_->queueRender();
+}
+
+void MeshDisplayCustom::updateGeometryMode()
+{
+    // fixed function lighting only lights the front side of the single shared normal
+    bool indexed = indexed_geometry_property_->getBool();
+    if(indexed && !isLightingProgramSupported())
+    {
+        setStatus( StatusProperty::Warn, "Geometry Mode", "Indexed geometry needs GLSL to light both sides, using front and back faces." );
+        indexed = false;
+    }
+    else
+    {
+        deleteStatus( "Geometry Mode" );
+    }
+    mesh_builder_->setIndexed(indexed);
+}
+
+void MeshDisplayCustom::updateMeshLod()
+{
+    mesh_builder_->setLodEnabled(mesh_lod_property_->getBool());
+}
+
+void MeshDisplayCustom::updateVertexFormat()
+{
+    bool compact = compact_vertices_property_->getBool();
+    if(compact && !isCompactVertexProgramSupported())
+    {
+        setStatus( StatusProperty::Warn, "Vertex Format", "Compact vertices need GLSL vertex programs, using float vertices." );
+        compact = false;
+    }
+    else
+    {
+        deleteStatus( "Vertex Format" );
+    }
+    mesh_builder_->setCompact(compact);
+}
+
+void MeshDisplayCustom::updateMaterialPrograms()
+{
+    if(mesh_material_.isNull())
+        return;
+
+    // the fixed function projector pass is only used without GLSL, so it never draws compact or
+    // indexed vertices
+    Ogre::Pass* pass = mesh_material_->getTechnique(0)->getPass(0);
+    if(projector_program_)
+    {
+        size_t count = pass->getNumTextureUnitStates();
+        pass->setVertexProgram(getProjectorVertexProgram(compact_material_, count));
+        pass->setFragmentProgram(getProjectorFragmentProgram(count));
+    }
+    else if(isLightingProgramSupported())
+    {
+        pass->setVertexProgram(getLightingVertexProgram(compact_material_));
+        pass->setFragmentProgram(getLightingFragmentProgram());
+    }
+
+    // setting the programs resets their constants
+    updateProjectorMatrices();
+    updateImageAlpha();
+}
+
+void MeshDisplayCustom::updateProjectorMatrices()
+{
+    if(!projector_program_ || mesh_material_.isNull() || decal_frustum_ == NULL)
+        return;
+
+    std::vector<Ogre::Frustum*> frustums(1, decal_frustum_);
+    std::vector<float> focal_lengths(1, last_info_ ? last_info_->P[0] : 0.0f);
+    std::vector<ProjectorTexture*> textures(1, &texture_);
+    for(size_t i = 0; i < extra_projectors_.size(); i++)
+    {
+        frustums.push_back(extra_projectors_[i]->getFrustum());
+        focal_lengths.push_back(extra_projectors_[i]->getFocalLength());
+        textures.push_back(&extra_projectors_[i]->getTexture());
+    }
+
+    // the programs are built for the number of texture units, which follows the cameras
+    Ogre::Pass* pass = mesh_material_->getTechnique(0)->getPass(0);
+    if(pass->getNumTextureUnitStates() != frustums.size())
+        return;
 
-    mesh_material_->setCullingMode(Ogre::CULL_NONE);
+    // same texture coordinates as fixed function projective texturing
+    std::vector<Ogre::Matrix4> matrices(frustums.size());
+    std::vector<float> positions(frustums.size() * 4);
+    // raw bayer textures are debayered by the fragment program, which needs their size and pattern
+    std::vector<float> bayer(frustums.size() * 4, 0.0f);
+    for(size_t i = 0; i < frustums.size(); i++)
+    {
+        int red = textures[i]->getBayerRed();
+        if(red >= 0)
+        {
+            bayer[i*4+0] = textures[i]->getWidth();
+            bayer[i*4+1] = textures[i]->getHeight();
+            bayer[i*4+2] = red % 2;
+            bayer[i*4+3] = red / 2;
+        }
 
-    last_mesh_ = *mesh;
+        matrices[i] = Ogre::Matrix4::CLIPSPACE2DTOIMAGESPACE * frustums[i]->getProjectionMatrix() * frustums[i]->getViewMatrix();
+        Ogre::Vector3 position = frustums[i]->getParentSceneNode()->_getDerivedPosition();
+        positions[i*4+0] = position.x;
+        positions[i*4+1] = position.y;
+        positions[i*4+2] = position.z;
+        positions[i*4+3] = focal_lengths[i];
+    }
+    pass->getVertexProgramParameters()->setNamedConstant("projector_matrices", &matrices[0], matrices.size());
+    pass->getFragmentProgramParameters()->setNamedConstant("projector_positions", &positions[0], frustums.size(), 4);
+    pass->getFragmentProgramParameters()->setNamedConstant("projector_bayer", &bayer[0], frustums.size(), 4);
+}
+
+void MeshDisplayCustom::updateImageAlpha()
+{
+    if(decal_tex_state_ == NULL)
+        return;
+
+    // the image alpha is a constant, so changing it doesn't require new images
+    float alpha = std::min(std::max(image_alpha_property_->getFloat(), 0.0f), 1.0f);
+    if(projector_program_)
+        mesh_material_->getTechnique(0)->getPass(0)->getFragmentProgramParameters()->setNamedConstant("image_alpha", alpha);
+    else
+        decal_tex_state_->setAlphaOperation(Ogre::LBX_MODULATE, Ogre::LBS_TEXTURE, Ogre::LBS_MANUAL, 1.0f, alpha);
 }
 
 void MeshDisplayCustom::updateMeshProperties()
@@ -266,6 +633,8 @@ void MeshDisplayCustom::updateMeshProperties()
     // update transformations
     setPose();
 
+    updateImageAlpha();
+
     // update color/alpha
     Ogre::Technique* technique = mesh_material_->getTechnique(0);
     Ogre::Pass* pass = technique->getPass(0);
@@ -295,6 +664,9 @@ void MeshDisplayCustom::updateTopic()
 {
     unsubscribe();
     subscribe();
+
+    if(snapshot_restored_)
+        mesh_builder_->setSnapshotPath(getSnapshotPath(getSnapshotName()));
 }
 
 void MeshDisplayCustom::subscribe()
@@ -317,14 +689,48 @@ void MeshDisplayCustom::subscribe()
         }
     }
 
+    if( !mesh_block_topic_property_->getTopic().isEmpty() )
+    {
+        try
+        {
+            // blocks must not be dropped, every one of them may touch a different region
+            block_sub_ = nh_.subscribe( mesh_block_topic_property_->getTopicStd(), 100, &MeshDisplayCustom::updateMeshBlock, this );
+            setStatus( StatusProperty::Ok, "Block Topic", "OK" );
+        }
+        catch( ros::Exception& e )
+        {
+            setStatus( StatusProperty::Error, "Block Topic", QString( "Error subscribing: " ) + e.what() );
+        }
+    }
+
     if( !topic_property_->getTopic().isEmpty() )
     {
         std::string target_frame = fixed_frame_.toStdString();
         ImageDisplayBase::enableTFFilter(target_frame);
 
-        ImageDisplayBase::subscribe();
-
         std::string topic = topic_property_->getTopicStd();
+
+        if(transport_property_->getStdString() == "compressed")
+        {
+            // decode on the worker pool instead of inside image_transport on the update thread
+            if(decode_pool_ == NULL)
+                decode_pool_ = new ImageDecodePool(boost::bind(&MeshDisplayCustom::processMessage, this, _1));
+
+            try
+            {
+                compressed_sub_ = update_nh_.subscribe( topic + "/compressed", (uint32_t)queue_size_property_->getInt(),
+                                                        &MeshDisplayCustom::compressedImageCallback, this );
+                setStatus( StatusProperty::Ok, "Topic", "OK" );
+            }
+            catch( ros::Exception& e )
+            {
+                setStatus( StatusProperty::Error, "Topic", QString( "Error subscribing: " ) + e.what() );
+            }
+        }
+        else
+        {
+            ImageDisplayBase::subscribe();
+        }
         std::string caminfo_topic = image_transport::getCameraInfoTopic(topic);
 
         try
@@ -337,13 +743,56 @@ void MeshDisplayCustom::subscribe()
           setStatus( StatusProperty::Error, "Camera Info", QString( "Error subscribing: ") + e.what() );
         }
     }
+
+    std::stringstream extra_topics(extra_image_topics_property_->getStdString());
+    std::string extra_topic;
+    deleteStatus( "Additional Image Topics" );
+    while(extra_topics >> extra_topic)
+    {
+        if(!isProjectorProgramSupported())
+        {
+            setStatus( StatusProperty::Warn, "Additional Image Topics", "Projecting more than one camera requires GLSL" );
+            break;
+        }
+        if(extra_projectors_.size() + 1 >= MAX_PROJECTORS)
+        {
+            setStatus( StatusProperty::Warn, "Additional Image Topics",
+                       QString( "At most %1 cameras are projected, %2 is ignored" ).arg( MAX_PROJECTORS ).arg( QString::fromStdString( extra_topic )));
+            break;
+        }
+
+        CameraProjector* projector = new CameraProjector(scene_manager_, context_->getFrameManager());
+        try
+        {
+            projector->subscribe( update_nh_, extra_topic, transport_property_->getStdString(), (uint32_t)queue_size_property_->getInt() );
+            extra_projectors_.push_back(projector);
+        }
+        catch( ros::Exception& e )
+        {
+            setStatus( StatusProperty::Error, QString::fromStdString( "Image " + extra_topic ), QString( "Error subscribing: " ) + e.what() );
+            delete projector;
+        }
+    }
 }
 
 void MeshDisplayCustom::unsubscribe()
 {
     ImageDisplayBase::unsubscribe();
+    compressed_sub_.shutdown();
+    if(decode_pool_ != NULL)
+        decode_pool_->clear();
     caminfo_sub_.unsubscribe();
     pose_sub_.shutdown();
+    block_sub_.shutdown();
+
+    for(size_t i = 0; i < extra_projectors_.size(); i++)
+    {
+        deleteStatus( QString::fromStdString( "Image " + extra_projectors_[i]->getTopic() ));
+        delete extra_projectors_[i];
+    }
+    extra_projectors_.clear();
+    // drops the texture units of the deleted cameras
+    updateProjectorTextures();
 }
 
 void MeshDisplayCustom::load()
@@ -387,6 +836,7 @@ void MeshDisplayCustom::load()
         pass->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
 
         mesh_material_->setCullingMode(Ogre::CULL_NONE);
+        updateMaterialPrograms();
     }
 
     mesh_node_ = this->scene_node_->createChildSceneNode();
@@ -406,6 +856,15 @@ void MeshDisplayCustom::update( float wall_dt, float ros_dt )
 {
     time_since_last_transform_ += wall_dt;
 
+    if(!snapshot_restored_)
+        restoreSnapshot();
+
+    // swap in the newest mesh finished by the builder, the previous one stays up until then
+    updateGeometry();
+
+    updateDecodeStatus();
+    updateMeshFileStatus();
+
 //    // just added automatic rotation to make it easier  to test things
 //    if(projector_node_ != NULL)
 //    {
@@ -413,6 +872,8 @@ void MeshDisplayCustom::update( float wall_dt, float ros_dt )
 //        rotation_property_->setQuaternion(projector_node_->getOrientation());
 //    }
 
+    updateTextureLod();
+
     if( !topic_property_->getTopic().isEmpty() )
     {
         std::string caminfo_topic = image_transport::getCameraInfoTopic(topic_property_->getTopicStd());
@@ -435,13 +896,122 @@ void MeshDisplayCustom::update( float wall_dt, float ros_dt )
 
         try
         {
-            updateCamera(texture_.update());
+            // switches to the image uploaded last frame and starts uploading the next one
+            bool new_image = texture_.update();
+
+            // the projected texture rotates through the texture ring
+            if(decal_tex_state_ != NULL && decal_tex_state_->getTextureName() != texture_.getTexture()->getName())
+                decal_tex_state_->setTextureName(texture_.getTexture()->getName());
+
+            updateCamera(new_image);
         }
         catch( UnsupportedImageEncoding& e )
         {
             setStatus(StatusProperty::Error, "Image", e.what());
         }
     }
+
+    updateExtraProjectors();
+    updateProjectorMatrices();
+}
+
+void MeshDisplayCustom::updateTextureLod()
+{
+    // every camera is downsampled to the screen area covered by the part of the meshes it projects onto
+    Ogre::AxisAlignedBox bounds;
+    for(std::map<std::string, MeshGeometry*>::const_iterator it = mesh_geometries_.begin(); it != mesh_geometries_.end(); ++it)
+    {
+        if(it->second->getVertexCount() > 0)
+            bounds.merge(it->second->getWorldBoundingBox());
+    }
+
+    setTextureDownsample(texture_, decal_frustum_, bounds);
+    for(size_t i = 0; i < extra_projectors_.size(); i++)
+        setTextureDownsample(extra_projectors_[i]->getTexture(), extra_projectors_[i]->getFrustum(), bounds);
+}
+
+Ogre::AxisAlignedBox MeshDisplayCustom::getFrustumBounds(Ogre::Frustum* frustum)
+{
+    // the corners of the clip space cube, back in world space; the projection is a custom matrix,
+    // so the corners are taken from it rather than from the frustum's own clip distances
+    Ogre::Matrix4 inverse = (frustum->getProjectionMatrix() * frustum->getViewMatrix()).inverse();
+    Ogre::AxisAlignedBox bounds;
+    for(int i = 0; i < 8; i++)
+    {
+        Ogre::Vector4 p = inverse * Ogre::Vector4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+        if(p.w <= 0.0f)
+            return Ogre::AxisAlignedBox(Ogre::AxisAlignedBox::EXTENT_INFINITE);
+        bounds.merge(Ogre::Vector3(p.x/p.w, p.y/p.w, p.z/p.w));
+    }
+    return bounds;
+}
+
+bool MeshDisplayCustom::getScreenSize(const Ogre::AxisAlignedBox& bounds, float& width_px, float& height_px)
+{
+    ViewController* view = context_->getViewManager()->getCurrent();
+    if(view == NULL || !bounds.isFinite())
+        return false;
+
+    Ogre::Camera* camera = view->getCamera();
+    Ogre::Viewport* viewport = camera->getViewport();
+    if(viewport == NULL)
+        return false;
+
+    // screen rectangle covered by the box
+    Ogre::Matrix4 view_proj = camera->getProjectionMatrix() * camera->getViewMatrix();
+    const Ogre::Vector3* corners = bounds.getAllCorners();
+    Ogre::Vector2 min_ndc(1.0f, 1.0f), max_ndc(-1.0f, -1.0f);
+    for(int i = 0; i < 8; i++)
+    {
+        Ogre::Vector4 p = view_proj * Ogre::Vector4(corners[i]);
+        // the camera is inside or right next to the mesh, keep full resolution
+        if(p.w <= 0.0f)
+            return false;
+        min_ndc.makeFloor(Ogre::Vector2(p.x/p.w, p.y/p.w));
+        max_ndc.makeCeil(Ogre::Vector2(p.x/p.w, p.y/p.w));
+    }
+
+    min_ndc.makeCeil(Ogre::Vector2(-1.0f, -1.0f));
+    max_ndc.makeFloor(Ogre::Vector2(1.0f, 1.0f));
+    width_px = std::max(max_ndc.x - min_ndc.x, 0.0f) * 0.5f * viewport->getActualWidth();
+    height_px = std::max(max_ndc.y - min_ndc.y, 0.0f) * 0.5f * viewport->getActualHeight();
+    return true;
+}
+
+void MeshDisplayCustom::setTextureDownsample(ProjectorTexture& texture, Ogre::Frustum* frustum, const Ogre::AxisAlignedBox& mesh_bounds)
+{
+    const sensor_msgs::Image::ConstPtr& image = texture.getImage();
+    float width_px = 0.0f, height_px = 0.0f;
+    if(!image || !texture_lod_property_->getBool() || frustum == NULL || mesh_bounds.isNull())
+    {
+        if(texture.getDownsample() != 1)
+            texture.setDownsample(1);
+        return;
+    }
+
+    // only the part of the meshes inside the projector frustum shows the image; a projector that
+    // misses every mesh covers nothing and gets the smallest image
+    Ogre::AxisAlignedBox covered = mesh_bounds.intersection(getFrustumBounds(frustum));
+    if(!covered.isNull() && !getScreenSize(covered, width_px, height_px))
+        width_px = height_px = -1.0f;
+
+    // the image is doubled as soon as it has fewer pixels than the mesh covers, but only halved
+    // while the halved image still has a margin over the covered pixels
+    uint32_t factor = texture.getDownsample();
+    while(factor > 1 &&
+          (image->width / factor < width_px || image->height / factor < height_px || width_px < 0.0f))
+    {
+        factor /= 2;
+    }
+    while(factor < MAX_TEXTURE_DOWNSAMPLE && width_px >= 0.0f &&
+          image->width / (factor*2) >= width_px * TEXTURE_DOWNSAMPLE_MARGIN &&
+          image->height / (factor*2) >= height_px * TEXTURE_DOWNSAMPLE_MARGIN)
+    {
+        factor *= 2;
+    }
+
+    if(factor != texture.getDownsample())
+        texture.setDownsample(factor);
 }
 
 bool MeshDisplayCustom::updateCamera(bool update_image)
@@ -486,15 +1056,15 @@ bool MeshDisplayCustom::updateCamera(bool update_image)
     if( img_width <= 0 )
     {
       ROS_ERROR( "Malformed CameraInfo on camera [%s], width = 0", qPrintable( getName() ));
-      // use texture size, but have to remove border from the perspective calculations
-      img_width = texture_.getWidth()-2;
+      // use image size, the texture may be downsampled
+      img_width = last_image_->width;
     }
 
     if (img_height <= 0)
     {
         ROS_ERROR( "Malformed CameraInfo on camera [%s], height = 0", qPrintable( getName() ));
-        // use texture size, but have to remove border from the perspective calculations
-        img_height = texture_.getHeight()-2;
+        // use image size, the texture may be downsampled
+        img_height = last_image_->height;
     }
 
     // if even the texture has 0 size, return
@@ -508,17 +1078,7 @@ bool MeshDisplayCustom::updateCamera(bool update_image)
     // calculate projection matrix
     if(last_info_->P[0] != 0)
     {
-        double fx = last_info_->P[0];
-        double fy = last_info_->P[5];
-
-        // Add the camera's translation relative to the left camera (from P[3]);
-        double tx = -1 * (last_info_->P[3] / fx);
-        Ogre::Vector3 right = orientation * Ogre::Vector3::UNIT_X;
-        position = position + (right * tx);
-
-        double ty = -1 * (last_info_->P[7] / fy);
-        Ogre::Vector3 down = orientation * Ogre::Vector3::UNIT_Y;
-        position = position + (down * ty);
+        Ogre::Matrix4 proj_matrix = getCameraProjection(*last_info_, img_width, img_height, orientation, position);
 
         if( !validateFloats( position ))
         {
@@ -533,27 +1093,6 @@ bool MeshDisplayCustom::updateCamera(bool update_image)
             projector_node_->setOrientation( orientation );
         }
 
-        // calculate the projection matrix
-        double cx = last_info_->P[2];
-        double cy = last_info_->P[6];
-
-        double far_plane = 100;
-        double near_plane = 0.01;
-
-        Ogre::Matrix4 proj_matrix;
-        proj_matrix = Ogre::Matrix4::ZERO;
-
-        proj_matrix[0][0]= 2.0 * fx/img_width;
-        proj_matrix[1][1]= 2.0 * fy/img_height;
-
-        proj_matrix[0][2]= 2.0 * (0.5 - cx/img_width);
-        proj_matrix[1][2]= 2.0 * (cy/img_height - 0.5);
-
-        proj_matrix[2][2]= -(far_plane+near_plane) / (far_plane-near_plane);
-        proj_matrix[2][3]= -2.0*far_plane*near_plane / (far_plane-near_plane);
-
-        proj_matrix[3][2]= -1;
-
         hfov_ = atan( 1.0f / proj_matrix[0][0] ) * 2.0f * 57.2957795f;
         vfov_ = atan( 1.0f / proj_matrix[1][1] ) * 2.0f * 57.2957795f;
 
@@ -572,6 +1111,7 @@ bool MeshDisplayCustom::updateCamera(bool update_image)
         createProjector();
 
         addDecalToMaterial(mesh_material_->getName());
+        updateMaterialPrograms();
     }
 
     return true;
@@ -598,35 +1138,28 @@ void MeshDisplayCustom::reset()
 void MeshDisplayCustom::processMessage(const sensor_msgs::Image::ConstPtr& msg)
 {
     //std::cout<<"camera image received"<<std::endl;
-    cv_bridge::CvImagePtr cv_ptr;
+    // image alpha and border are applied by the projector material, so the image is
+    // handed to the texture in its native encoding
+    texture_.addMessage(msg);
+}
 
-    // simply converting every image to RGBA
-    try
-    {
-        cv_ptr = cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::RGBA8);
-    }
-    catch (cv_bridge::Exception& e)
-    {
-        ROS_ERROR("MeshDisplayCustom: cv_bridge exception: %s", e.what());
-        return;
-    }
+void MeshDisplayCustom::compressedImageCallback( const sensor_msgs::CompressedImage::ConstPtr& msg )
+{
+    decode_pool_->addMessage(msg);
+}
 
-    // update image alpha
-    for(int i = 0; i < cv_ptr->image.rows; i++)
-    {
-        for(int j = 0; j < cv_ptr->image.cols; j++)
-        {
-            cv::Vec4b& pixel = cv_ptr->image.at<cv::Vec4b>(i,j);
-            pixel[3] = image_alpha_property_->getFloat()*255;
-        }
-    }
+void MeshDisplayCustom::updateDecodeStatus()
+{
+    if(decode_pool_ == NULL || compressed_sub_.getTopic().empty())
+        return;
 
-    // add completely white transparent border to the image so that it won't replicate colored pixels all over the mesh
-    cv::Scalar value(255,255,255,0);
-    cv::copyMakeBorder(cv_ptr->image,cv_ptr->image,1,1,1,1,cv::BORDER_CONSTANT,value);
+    unsigned int delivered, dropped;
+    decode_pool_->getStatistics(delivered, dropped);
+    if(delivered == 0)
+        return;
 
-    // Output modified video stream
-    texture_.addMessage(cv_ptr->toImageMsg());
+    compressed_received_ += delivered;
+    setStatus( StatusProperty::Ok, "Image", QString::number( compressed_received_ ) + " images received" );
 }
 
 void MeshDisplayCustom::caminfoCallback( const sensor_msgs::CameraInfo::ConstPtr& msg )
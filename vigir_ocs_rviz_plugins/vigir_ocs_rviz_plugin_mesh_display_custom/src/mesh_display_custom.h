@@ -44,6 +44,7 @@
 
 #include <image_transport/image_transport.h>
 #include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/CompressedImage.h>
 #include <message_filters/subscriber.h>
 #include <tf/message_filter.h>
 
@@ -51,6 +52,7 @@
 #include <geometry_msgs/PoseStamped.h>
 #include <shape_msgs/Mesh.h>
 #include <std_msgs/Float64.h>
+#include <vigir_ocs_rviz_plugins/MeshBlock.h>
 
 #include <tf/transform_listener.h>
 
@@ -67,6 +69,9 @@
 
 #include <map>
 
+#include "mesh_buffer.h"
+#include "projector_texture.h"
+
 namespace Ogre
 {
 class Entity;
@@ -78,12 +83,18 @@ namespace rviz
 {
 class Axes;
 class RenderPanel;
+class BoolProperty;
 class FloatProperty;
 class RosTopicProperty;
 class ColorProperty;
 class VectorProperty;
 class StringProperty;
 class QuaternionProperty;
+class CameraProjector;
+class ImageDecodePool;
+class MeshBuilder;
+class MeshFileLoader;
+class MeshGeometry;
 }
 
 namespace rviz
@@ -108,6 +119,10 @@ public:
 
 private Q_SLOTS:
   void updateMeshProperties();
+  void updateGeometryMode();
+  void updateMeshLod();
+  void updateVertexFormat();
+  void updateMeshFile();
   void updateTopic();
   void updateName();
   virtual void updateQueueSize();
@@ -131,23 +146,48 @@ private:
   void updateStatus();
   bool updateCamera(bool update_image);
   void caminfoCallback( const sensor_msgs::CameraInfo::ConstPtr& msg );
+  void updateImageAlpha();
+  void compressedImageCallback( const sensor_msgs::CompressedImage::ConstPtr& msg );
+  void updateDecodeStatus();
+  void updateTextureLod();
+  static Ogre::AxisAlignedBox getFrustumBounds(Ogre::Frustum* frustum);
+  bool getScreenSize(const Ogre::AxisAlignedBox& bounds, float& width_px, float& height_px);
+  void setTextureDownsample(ProjectorTexture& texture, Ogre::Frustum* frustum, const Ogre::AxisAlignedBox& mesh_bounds);
+  void updateMaterialPrograms();
+  void updateProjectorMatrices();
 
   void createProjector();
   void addDecalToMaterial(const Ogre::String& matName);
+  Ogre::TextureUnitState* createProjectorTextureUnit(Ogre::Pass* pass, const std::string& texture_name);
+  void updateExtraProjectors();
+  void updateProjectorTextures();
   void updateMesh( const shape_msgs::Mesh::ConstPtr& mesh );
+  void updateMeshBlock( const vigir_ocs_rviz_plugins::MeshBlock::ConstPtr& block );
+  void meshFileCallback( const shape_msgs::Mesh::ConstPtr& mesh, const std::string& cache_path );
+  void meshFileBufferCallback( const MeshBufferPtr& buffer, uint64_t fingerprint, const std::string& cache_path );
+  void updateMeshFileStatus();
+  void restoreSnapshot();
+  std::string getSnapshotName();
+  void updateGeometry();
 
   float time_since_last_transform_;
 
   RosTopicProperty* mesh_topic_property_;
+  RosTopicProperty* mesh_block_topic_property_;
+  StringProperty* mesh_file_property_;
+  StringProperty* extra_image_topics_property_;
   FloatProperty* mesh_alpha_property_;
   FloatProperty* image_alpha_property_;
   ColorProperty* mesh_color_property_;
   VectorProperty* position_property_;
   StringProperty* type_property_;
   QuaternionProperty* rotation_property_;
+  BoolProperty* indexed_geometry_property_;
+  BoolProperty* mesh_lod_property_;
+  BoolProperty* compact_vertices_property_;
+  BoolProperty* texture_lod_property_;
 
   geometry_msgs::Pose pose_;
-  shape_msgs::Mesh last_mesh_;
 
   ros::NodeHandle nh_;
 
@@ -164,14 +204,34 @@ private:
   float hfov_, vfov_;
 
   Ogre::SceneNode* mesh_node_;
-  Ogre::ManualObject* manual_object_;
+  // one geometry per mesh block, the plain mesh topic is the block with an empty id
+  std::map<std::string, MeshGeometry*> mesh_geometries_;
+  MeshBuilder* mesh_builder_;
+  // static models from disk are shown as one more block next to the topics
+  MeshFileLoader* mesh_file_loader_;
+  // the last meshes are restored from disk once, on the first update after the topics are known
+  bool snapshot_restored_;
+  // the material decodes compact vertices with vertex programs, follows the uploaded geometry
+  bool compact_material_;
+  // the image is blended in the lit pass by GLSL programs, otherwise by a second fixed function pass
+  bool projector_program_;
   Ogre::MaterialPtr mesh_material_;
-  ROSImageTexture texture_;
+  ProjectorTexture texture_;
+  static const uint32_t MAX_TEXTURE_DOWNSAMPLE = 8;
+
+  // compressed images are subscribed directly and decoded in parallel
+  ros::Subscriber compressed_sub_;
+  ImageDecodePool* decode_pool_;
+  unsigned int compressed_received_;
 
   ros::Subscriber pose_sub_;
+  ros::Subscriber block_sub_;
 
   Ogre::Frustum* decal_frustum_;
+  Ogre::TextureUnitState* decal_tex_state_;
   std::vector<Ogre::Frustum*> filter_frustum_; //need multiple filters (back, up, down, left, right)
+  // cameras blended into the same material after the one of the image topic, GLSL only
+  std::vector<CameraProjector*> extra_projectors_;
   Ogre::SceneNode* projector_node_;
 
   std::vector<RenderPanel*> render_panel_list_;
@@ -0,0 +1,696 @@
+/*
+ * MeshFileLoader class implementation.
+ *
+ * Loads binary PLY and STL files for MeshDisplayCustom in the background.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <ros/ros.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <sstream>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mesh_file_loader.h"
+#include "mesh_hash.h"
+#include "mesh_snapshot.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// part of the cache key, bump it whenever parsing changes so old cache files are not used
+const uint64_t CACHE_VERSION = 2;
+
+// the least recently used cache files are deleted beyond this size
+const uint64_t CACHE_MAX_BYTES = 8ull << 30;
+
+bool isLittleEndian()
+{
+  uint16_t one = 1;
+  return *reinterpret_cast<unsigned char*>( &one ) == 1;
+}
+
+enum PlyType
+{
+  PLY_INVALID,
+  PLY_INT8,
+  PLY_UINT8,
+  PLY_INT16,
+  PLY_UINT16,
+  PLY_INT32,
+  PLY_UINT32,
+  PLY_FLOAT32,
+  PLY_FLOAT64
+};
+
+PlyType parsePlyType( const std::string& name )
+{
+  if( name == "char" || name == "int8" ) return PLY_INT8;
+  if( name == "uchar" || name == "uint8" ) return PLY_UINT8;
+  if( name == "short" || name == "int16" ) return PLY_INT16;
+  if( name == "ushort" || name == "uint16" ) return PLY_UINT16;
+  if( name == "int" || name == "int32" ) return PLY_INT32;
+  if( name == "uint" || name == "uint32" ) return PLY_UINT32;
+  if( name == "float" || name == "float32" ) return PLY_FLOAT32;
+  if( name == "double" || name == "float64" ) return PLY_FLOAT64;
+  return PLY_INVALID;
+}
+
+size_t getPlyTypeSize( PlyType type )
+{
+  switch( type )
+  {
+  case PLY_INT8: case PLY_UINT8: return 1;
+  case PLY_INT16: case PLY_UINT16: return 2;
+  case PLY_INT32: case PLY_UINT32: case PLY_FLOAT32: return 4;
+  case PLY_FLOAT64: return 8;
+  default: return 0;
+  }
+}
+
+template<typename T>
+T readRaw( const unsigned char* data, bool swap )
+{
+  unsigned char bytes[sizeof(T)];
+  memcpy( bytes, data, sizeof(T) );
+  if( swap )
+    std::reverse( bytes, bytes + sizeof(T) );
+  T value;
+  memcpy( &value, bytes, sizeof(T) );
+  return value;
+}
+
+double readPlyValue( const unsigned char* data, PlyType type, bool swap )
+{
+  switch( type )
+  {
+  case PLY_INT8: return (int8_t)data[0];
+  case PLY_UINT8: return data[0];
+  case PLY_INT16: return readRaw<int16_t>( data, swap );
+  case PLY_UINT16: return readRaw<uint16_t>( data, swap );
+  case PLY_INT32: return readRaw<int32_t>( data, swap );
+  case PLY_UINT32: return readRaw<uint32_t>( data, swap );
+  case PLY_FLOAT32: return readRaw<float>( data, swap );
+  case PLY_FLOAT64: return readRaw<double>( data, swap );
+  default: return 0.0;
+  }
+}
+
+// what a property is used for while reading the data
+enum PlyRole
+{
+  PLY_SKIP,
+  PLY_X,
+  PLY_Y,
+  PLY_Z,
+  PLY_FACE
+};
+
+struct PlyProperty
+{
+  std::string name;
+  PlyType type;
+  // lists are prefixed by their length in count_type, type is the type of the items
+  bool is_list;
+  PlyType count_type;
+  PlyRole role;
+};
+
+struct PlyElement
+{
+  std::string name;
+  size_t count;
+  std::vector<PlyProperty> properties;
+};
+
+const uint32_t EMPTY_SLOT = 0xffffffff;
+
+// welds STL corners with bitwise identical positions into shared vertices
+class VertexWelder
+{
+public:
+  explicit VertexWelder( size_t expected_vertices )
+  {
+    size_t size = 1024;
+    while( size < expected_vertices * 2 )
+      size *= 2;
+    table_.assign( size, EMPTY_SLOT );
+  }
+
+  uint32_t add( const float* position )
+  {
+    if(( positions_.size() / 3 + 1 ) * 2 > table_.size() )
+      grow();
+
+    size_t mask = table_.size() - 1;
+    for( size_t slot = hash( position ) & mask; ; slot = ( slot + 1 ) & mask )
+    {
+      uint32_t index = table_[slot];
+      if( index == EMPTY_SLOT )
+      {
+        index = positions_.size() / 3;
+        positions_.insert( positions_.end(), position, position + 3 );
+        table_[slot] = index;
+        return index;
+      }
+      if( memcmp( &positions_[index*3], position, 3*sizeof(float) ) == 0 )
+        return index;
+    }
+  }
+
+  const std::vector<float>& getPositions() const { return positions_; }
+
+private:
+  static size_t hash( const float* position )
+  {
+    uint32_t bits[3];
+    memcpy( bits, position, sizeof(bits) );
+    uint64_t h = bits[0] * 0x9E3779B185EBCA87ULL ^ bits[1] * 0xC2B2AE3D27D4EB4FULL ^ bits[2] * 0x165667B19E3779F9ULL;
+    return h ^ ( h >> 29 );
+  }
+
+  void grow()
+  {
+    table_.assign( table_.size() * 2, EMPTY_SLOT );
+    size_t mask = table_.size() - 1;
+    for( uint32_t index = 0; index < positions_.size() / 3; index++ )
+    {
+      size_t slot = hash( &positions_[index*3] ) & mask;
+      while( table_[slot] != EMPTY_SLOT )
+        slot = ( slot + 1 ) & mask;
+      table_[slot] = index;
+    }
+  }
+
+  std::vector<uint32_t> table_;
+  std::vector<float> positions_;
+};
+
+std::string toLower( std::string s )
+{
+  std::transform( s.begin(), s.end(), s.begin(), ::tolower );
+  return s;
+}
+
+} // namespace
+
+MeshFileLoader::MeshFileLoader( const MeshCallback& mesh_callback, const BufferCallback& buffer_callback )
+  : mesh_callback_( mesh_callback )
+  , buffer_callback_( buffer_callback )
+  , pending_( false )
+  , generation_( 0 )
+  , running_( true )
+  , status_ready_( false )
+  , status_ok_( false )
+{
+  thread_ = boost::thread( boost::bind( &MeshFileLoader::run, this ) );
+}
+
+MeshFileLoader::~MeshFileLoader()
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    running_ = false;
+  }
+  condition_.notify_all();
+  thread_.join();
+}
+
+void MeshFileLoader::load( const std::string& path )
+{
+  // waits for a delivery in progress, so no mesh of an older request arrives after this returns
+  boost::mutex::scoped_lock delivery_lock( delivery_mutex_ );
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    generation_++;
+    pending_path_ = path;
+    pending_ = !path.empty();
+    status_ready_ = false;
+  }
+  condition_.notify_one();
+}
+
+bool MeshFileLoader::takeStatus( bool& ok, std::string& message )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  if( !status_ready_ )
+    return false;
+  ok = status_ok_;
+  message = status_message_;
+  status_ready_ = false;
+  return true;
+}
+
+void MeshFileLoader::run()
+{
+  while( true )
+  {
+    std::string path;
+    unsigned int generation;
+    {
+      boost::mutex::scoped_lock lock( mutex_ );
+      while( running_ && !pending_ )
+        condition_.wait( lock );
+      if( !running_ )
+        return;
+
+      path = pending_path_;
+      pending_ = false;
+      generation = generation_;
+    }
+
+    std::string message;
+    shape_msgs::Mesh::Ptr mesh;
+    MeshBufferPtr buffer;
+    uint64_t fingerprint = 0;
+    std::string cache_path;
+    try
+    {
+      MappedFile file;
+      if( !file.open( path ))
+      {
+        message = "Cannot open " + path + ": " + strerror( errno );
+      }
+      else
+      {
+        std::string cache_directory = getCacheDirectory();
+        cache_path = getCachePath( file.getData(), file.getSize(), cache_directory );
+        if( !cache_path.empty() && readCache( cache_path, buffer, fingerprint ))
+        {
+          // marks the file as recently used for pruneCache()
+          utimes( cache_path.c_str(), NULL );
+          std::stringstream ss;
+          ss << buffer->triangle_count << " triangles loaded from cache";
+          message = ss.str();
+        }
+        else
+        {
+          buffer.reset();
+          mesh = readMesh( path, file.getData(), file.getSize(), message );
+          // makes room for the file the builder writes
+          if( mesh && !cache_directory.empty() )
+            pruneCache( cache_directory, CACHE_MAX_BYTES );
+        }
+      }
+    }
+    catch( const std::exception& e )
+    {
+      // e.g. a file too large for memory, reported like any other load error
+      message = path + ": " + e.what();
+      mesh.reset();
+      buffer.reset();
+    }
+
+    boost::mutex::scoped_lock delivery_lock( delivery_mutex_ );
+    {
+      boost::mutex::scoped_lock lock( mutex_ );
+      if( generation != generation_ )
+        continue;
+      status_ready_ = true;
+      status_ok_ = mesh || buffer;
+      status_message_ = message;
+    }
+
+    // the builder writes the cache once it has built the mesh
+    if( buffer )
+      buffer_callback_( buffer, fingerprint, cache_path );
+    else if( mesh )
+      mesh_callback_( mesh, cache_path );
+  }
+}
+
+shape_msgs::Mesh::Ptr MeshFileLoader::readFile( const std::string& path, std::string& message )
+{
+  MappedFile file;
+  if( !file.open( path ))
+  {
+    message = "Cannot open " + path + ": " + strerror( errno );
+    return shape_msgs::Mesh::Ptr();
+  }
+  return readMesh( path, file.getData(), file.getSize(), message );
+}
+
+shape_msgs::Mesh::Ptr MeshFileLoader::readMesh( const std::string& path, const unsigned char* data, size_t size, std::string& message )
+{
+  shape_msgs::Mesh::Ptr mesh( new shape_msgs::Mesh() );
+  std::string error;
+  bool is_ply = size >= 3 && memcmp( data, "ply", 3 ) == 0;
+  if( !is_ply && path.size() > 4 && toLower( path.substr( path.size() - 4 )) == ".ply" )
+  {
+    message = path + " does not start with a PLY header";
+    return shape_msgs::Mesh::Ptr();
+  }
+  bool ok = is_ply ? readPly( data, size, *mesh, error ) : readStl( data, size, *mesh, error );
+  if( !ok )
+  {
+    message = path + ": " + error;
+    return shape_msgs::Mesh::Ptr();
+  }
+
+  std::stringstream ss;
+  ss << mesh->triangles.size() << " triangles loaded";
+  message = ss.str();
+  return mesh;
+}
+
+bool MeshFileLoader::readPly( const unsigned char* data, size_t size, shape_msgs::Mesh& mesh, std::string& error )
+{
+  const char END_HEADER[] = "end_header";
+  const unsigned char* header_end = std::search( data, data + size, END_HEADER, END_HEADER + sizeof(END_HEADER) - 1 );
+  header_end = std::find( header_end, data + size, '\n' );
+  if( header_end == data + size )
+  {
+    error = "PLY header is not terminated";
+    return false;
+  }
+
+  std::istringstream header( std::string( data, header_end ));
+  std::vector<PlyElement> elements;
+  bool swap = false;
+  std::string line;
+  while( std::getline( header, line ))
+  {
+    std::istringstream tokens( line );
+    std::string keyword;
+    tokens >> keyword;
+    if( keyword == "format" )
+    {
+      std::string format;
+      tokens >> format;
+      if( format == "binary_little_endian" )
+        swap = !isLittleEndian();
+      else if( format == "binary_big_endian" )
+        swap = isLittleEndian();
+      else
+      {
+        error = "only binary PLY files are supported, not " + format;
+        return false;
+      }
+    }
+    else if( keyword == "element" )
+    {
+      // istream would wrap a negative count around, so digits are checked first
+      PlyElement element;
+      std::string count;
+      tokens >> element.name >> count;
+      char* count_end = NULL;
+      errno = 0;
+      unsigned long long value = strtoull( count.c_str(), &count_end, 10 );
+      if( element.name.empty() || count.empty() || count.find_first_not_of( "0123456789" ) != std::string::npos ||
+          *count_end != '\0' || errno == ERANGE || value > (unsigned long long)(size_t)-1 )
+      {
+        error = "invalid PLY element in: " + line;
+        return false;
+      }
+      element.count = value;
+      elements.push_back( element );
+    }
+    else if( keyword == "property" && !elements.empty() )
+    {
+      PlyProperty property;
+      std::string type;
+      tokens >> type;
+      property.is_list = type == "list";
+      property.count_type = PLY_INVALID;
+      if( property.is_list )
+      {
+        std::string count_type;
+        tokens >> count_type >> type;
+        property.count_type = parsePlyType( count_type );
+      }
+      tokens >> property.name;
+      property.type = parsePlyType( type );
+      if( property.type == PLY_INVALID || ( property.is_list && property.count_type == PLY_INVALID ))
+      {
+        error = "unknown PLY property type in: " + line;
+        return false;
+      }
+
+      const std::string& element = elements.back().name;
+      property.role = PLY_SKIP;
+      if( element == "vertex" && !property.is_list )
+      {
+        if( property.name == "x" ) property.role = PLY_X;
+        if( property.name == "y" ) property.role = PLY_Y;
+        if( property.name == "z" ) property.role = PLY_Z;
+      }
+      else if( element == "face" && property.is_list &&
+               ( property.name == "vertex_indices" || property.name == "vertex_index" ))
+      {
+        property.role = PLY_FACE;
+      }
+      elements.back().properties.push_back( property );
+    }
+  }
+
+  mesh.vertices.clear();
+  mesh.triangles.clear();
+  const unsigned char* p = header_end + 1;
+  const unsigned char* end = data + size;
+  for( size_t e = 0; e < elements.size(); e++ )
+  {
+    const PlyElement& element = elements[e];
+
+    // rows without properties take no bytes, so nothing would bound their count
+    if( element.properties.empty() && element.count > 0 )
+    {
+      error = "PLY element " + element.name + " has no properties";
+      return false;
+    }
+
+    // every row has at least its scalars and list lengths, which bounds the count before allocating
+    size_t min_row_size = 0;
+    for( size_t i = 0; i < element.properties.size(); i++ )
+      min_row_size += getPlyTypeSize( element.properties[i].is_list ? element.properties[i].count_type : element.properties[i].type );
+    if( min_row_size > 0 && element.count > (size_t)( end - p ) / min_row_size )
+    {
+      error = "PLY file is truncated in element " + element.name;
+      return false;
+    }
+
+    if( element.name == "vertex" )
+      mesh.vertices.resize( element.count );
+    if( element.name == "face" )
+      mesh.triangles.reserve( element.count );
+
+    std::vector<uint32_t> polygon;
+    for( size_t row = 0; row < element.count; row++ )
+    {
+      for( size_t i = 0; i < element.properties.size(); i++ )
+      {
+        const PlyProperty& property = element.properties[i];
+        size_t item_size = getPlyTypeSize( property.type );
+        if( !property.is_list )
+        {
+          if( (size_t)( end - p ) < item_size )
+          {
+            error = "PLY file is truncated in element " + element.name;
+            return false;
+          }
+          switch( property.role )
+          {
+          case PLY_X: mesh.vertices[row].x = readPlyValue( p, property.type, swap ); break;
+          case PLY_Y: mesh.vertices[row].y = readPlyValue( p, property.type, swap ); break;
+          case PLY_Z: mesh.vertices[row].z = readPlyValue( p, property.type, swap ); break;
+          default: break;
+          }
+          p += item_size;
+          continue;
+        }
+
+        size_t count_size = getPlyTypeSize( property.count_type );
+        if( (size_t)( end - p ) < count_size )
+        {
+          error = "PLY file is truncated in element " + element.name;
+          return false;
+        }
+        double list_length = readPlyValue( p, property.count_type, swap );
+        p += count_size;
+        if( list_length < 0.0 || list_length > (double)(( end - p ) / item_size ))
+        {
+          error = "PLY file is truncated in element " + element.name;
+          return false;
+        }
+        size_t count = (size_t)list_length;
+
+        if( property.role == PLY_FACE )
+        {
+          // polygons are split into a triangle fan
+          polygon.resize( count );
+          for( size_t c = 0; c < count; c++ )
+            polygon[c] = (uint32_t)(int64_t)readPlyValue( p + c*item_size, property.type, swap );
+          for( size_t c = 2; c < count; c++ )
+          {
+            shape_msgs::MeshTriangle triangle;
+            triangle.vertex_indices[0] = polygon[0];
+            triangle.vertex_indices[1] = polygon[c-1];
+            triangle.vertex_indices[2] = polygon[c];
+            mesh.triangles.push_back( triangle );
+          }
+        }
+        p += count * item_size;
+      }
+    }
+  }
+
+  if( mesh.vertices.empty() || mesh.triangles.empty() )
+  {
+    error = "PLY file has no vertex or face elements";
+    return false;
+  }
+  return true;
+}
+
+bool MeshFileLoader::readStl( const unsigned char* data, size_t size, shape_msgs::Mesh& mesh, std::string& error )
+{
+  // 80 byte header, triangle count, then normal, three corners and an attribute word per triangle
+  const size_t HEADER_SIZE = 84;
+  const size_t TRIANGLE_SIZE = 50;
+  if( size < HEADER_SIZE || readRaw<uint32_t>( data + 80, !isLittleEndian() ) != ( size - HEADER_SIZE ) / TRIANGLE_SIZE ||
+      ( size - HEADER_SIZE ) % TRIANGLE_SIZE != 0 )
+  {
+    error = size >= 5 && memcmp( data, "solid", 5 ) == 0 ? "ASCII STL files are not supported" : "not a binary STL file";
+    return false;
+  }
+
+  size_t triangle_count = ( size - HEADER_SIZE ) / TRIANGLE_SIZE;
+  bool swap = !isLittleEndian();
+  // closed meshes share every vertex between about six triangles
+  VertexWelder welder( triangle_count / 2 );
+  mesh.triangles.resize( triangle_count );
+  const unsigned char* p = data + HEADER_SIZE;
+  for( size_t t = 0; t < triangle_count; t++, p += TRIANGLE_SIZE )
+  {
+    for( size_t c = 0; c < 3; c++ )
+    {
+      float position[3];
+      for( size_t a = 0; a < 3; a++ )
+      {
+        // adding zero turns -0 into +0, so both weld into the same vertex
+        position[a] = readRaw<float>( p + 12 + c*12 + a*4, swap ) + 0.0f;
+      }
+      mesh.triangles[t].vertex_indices[c] = welder.add( position );
+    }
+  }
+
+  const std::vector<float>& positions = welder.getPositions();
+  mesh.vertices.resize( positions.size() / 3 );
+  for( size_t i = 0; i < mesh.vertices.size(); i++ )
+  {
+    mesh.vertices[i].x = positions[i*3];
+    mesh.vertices[i].y = positions[i*3+1];
+    mesh.vertices[i].z = positions[i*3+2];
+  }
+
+  if( mesh.triangles.empty() )
+  {
+    error = "STL file has no triangles";
+    return false;
+  }
+  return true;
+}
+
+std::string MeshFileLoader::getCachePath( const unsigned char* data, size_t size, const std::string& cache_directory )
+{
+  // keyed by content, so a copied or moved file still hits and a changed one is never served stale;
+  // hashing runs at memory bandwidth, far below the cost of parsing and building
+  if( cache_directory.empty() )
+    return std::string();
+  char name[32];
+  snprintf( name, sizeof(name), "%016llx.mesh", (unsigned long long)hashBytes( data, size, CACHE_VERSION ));
+  return cache_directory + "/" + name;
+}
+
+bool MeshFileLoader::readCache( const std::string& cache_path, MeshBufferPtr& buffer, uint64_t& fingerprint )
+{
+  std::map<std::string, MeshBufferPtr> buffers;
+  std::map<std::string, uint64_t> fingerprints;
+  if( !readMeshSnapshot( cache_path, buffers, fingerprints ) || buffers.size() != 1 )
+    return false;
+  buffer = buffers.begin()->second;
+  fingerprint = fingerprints.begin()->second;
+  return true;
+}
+
+void MeshFileLoader::pruneCache( const std::string& cache_directory, uint64_t max_bytes )
+{
+  DIR* directory = opendir( cache_directory.c_str() );
+  if( directory == NULL )
+    return;
+
+  // (modification time, size, path), files are touched whenever they are read
+  std::vector<std::pair<time_t, std::pair<uint64_t, std::string> > > files;
+  while( struct dirent* entry = readdir( directory ))
+  {
+    std::string name = entry->d_name;
+    struct stat info;
+    std::string path = cache_directory + "/" + name;
+    if( name.size() > 5 && name.compare( name.size() - 5, 5, ".mesh" ) == 0 && stat( path.c_str(), &info ) == 0 )
+      files.push_back( std::make_pair( info.st_mtime, std::make_pair( (uint64_t)info.st_size, path )));
+  }
+  closedir( directory );
+
+  std::sort( files.begin(), files.end() );
+  uint64_t total = 0;
+  for( size_t i = files.size(); i-- > 0; )
+  {
+    total += files[i].second.first;
+    if( total > max_bytes )
+      unlink( files[i].second.second.c_str() );
+  }
+}
+
+std::string MeshFileLoader::getCacheDirectory()
+{
+  std::string ros_home = getRosHomeDirectory();
+  return ros_home.empty() ? ros_home : ros_home + "/mesh_cache";
+}
+
+} // namespace rviz
@@ -0,0 +1,127 @@
+/*
+ * MeshFileLoader declaration.
+ *
+ * Loads binary PLY and STL files for MeshDisplayCustom in the background.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_MESH_FILE_LOADER_H
+#define RVIZ_MESH_FILE_LOADER_H
+
+#include <shape_msgs/Mesh.h>
+
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <string>
+
+#include "mesh_buffer.h"
+
+namespace rviz
+{
+
+/**
+ * \class MeshFileLoader
+ * \brief Reads static meshes from binary PLY or STL files on a worker thread.
+ *
+ * Files are memory mapped and parsed in place. Every file has a cache path named after the hash of
+ * its contents, where the MeshBuilder stores the built buffer and its levels of detail as a mesh
+ * snapshot. Loading the same contents again, from any path, hands over that buffer instead, so the
+ * file is hashed but neither parsed nor built again. The least recently used cache files are
+ * deleted once the cache grows beyond a few gigabytes. Only the newest requested file is loaded;
+ * a request made while a file is loading replaces it, and the older result is never delivered.
+ * The callbacks run on the worker thread.
+ */
+class MeshFileLoader
+{
+public:
+  // a parsed file, to be built and written to cache_path
+  typedef boost::function<void ( const shape_msgs::Mesh::ConstPtr&, const std::string& cache_path )> MeshCallback;
+  // a buffer from the cache together with the fingerprint of the mesh it was built from
+  typedef boost::function<void ( const MeshBufferPtr&, uint64_t fingerprint, const std::string& cache_path )> BufferCallback;
+
+  MeshFileLoader( const MeshCallback& mesh_callback, const BufferCallback& buffer_callback );
+  ~MeshFileLoader();
+
+  // loads path in the background; an empty path only cancels the current request
+  void load( const std::string& path );
+
+  // returns true once for every finished load, with whether it succeeded and a status message
+  bool takeStatus( bool& ok, std::string& message );
+
+  // parses path, returns an empty pointer and the reason in message if that fails
+  static shape_msgs::Mesh::Ptr readFile( const std::string& path, std::string& message );
+  // parses the mapped contents of path
+  static shape_msgs::Mesh::Ptr readMesh( const std::string& path, const unsigned char* data, size_t size, std::string& message );
+
+  static bool readPly( const unsigned char* data, size_t size, shape_msgs::Mesh& mesh, std::string& error );
+  static bool readStl( const unsigned char* data, size_t size, shape_msgs::Mesh& mesh, std::string& error );
+
+  // where the built mesh of a file with these contents is cached; empty if cache_directory is
+  static std::string getCachePath( const unsigned char* data, size_t size, const std::string& cache_directory );
+  // returns false if the cache is missing or damaged
+  static bool readCache( const std::string& cache_path, MeshBufferPtr& buffer, uint64_t& fingerprint );
+  // deletes the least recently used cache files until the others fit into max_bytes
+  static void pruneCache( const std::string& cache_directory, uint64_t max_bytes );
+
+  // $ROS_HOME/mesh_cache, falling back to ~/.ros/mesh_cache; empty if neither is known
+  static std::string getCacheDirectory();
+
+private:
+  void run();
+
+  MeshCallback mesh_callback_;
+  BufferCallback buffer_callback_;
+
+  boost::thread thread_;
+  boost::mutex mutex_;
+  boost::mutex delivery_mutex_;
+  boost::condition_variable condition_;
+
+  std::string pending_path_;
+  bool pending_;
+  unsigned int generation_;
+  bool running_;
+
+  bool status_ready_;
+  bool status_ok_;
+  std::string status_message_;
+};
+
+} // namespace rviz
+
+#endif
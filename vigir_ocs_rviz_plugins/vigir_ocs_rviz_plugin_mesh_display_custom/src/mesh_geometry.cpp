@@ -0,0 +1,334 @@
+/*
+ * MeshGeometry class implementation.
+ *
+ * Hardware buffers and spatial chunks of the mesh drawn by MeshDisplayCustom.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <OGRE/OgreHardwareBufferManager.h>
+#include <OGRE/OgreSceneManager.h>
+#include <OGRE/OgreSceneNode.h>
+#include <OGRE/OgreVector4.h>
+
+#include <algorithm>
+#include <string.h>
+
+#include "compact_vertex_program.h"
+#include "mesh_geometry.h"
+#include "mesh_renderable.h"
+#include "vertex_layout.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// copies indices into buffer, narrowing them to 16 bit if that is the buffer's index type
+void writeIndices( const Ogre::HardwareIndexBufferSharedPtr& buffer, const std::vector<uint32_t>& indices )
+{
+  void* data = buffer->lock( 0, indices.size() * buffer->getIndexSize(), Ogre::HardwareBuffer::HBL_DISCARD );
+  if( buffer->getType() == Ogre::HardwareIndexBuffer::IT_32BIT )
+  {
+    memcpy( data, &indices[0], indices.size() * sizeof(uint32_t) );
+  }
+  else
+  {
+    std::copy( indices.begin(), indices.end(), static_cast<uint16_t*>( data ));
+  }
+  buffer->unlock();
+}
+
+} // namespace
+
+MeshGeometry::MeshGeometry( Ogre::SceneNode* parent_node )
+  : parent_node_( parent_node )
+  , vertex_count_( 0 )
+  , index_count_( 0 )
+  , dynamic_( false )
+  , compact_( false )
+{
+  vertex_data_ = new Ogre::VertexData();
+  vertex_data_->vertexStart = 0;
+  vertex_data_->vertexCount = 0;
+
+  setLayout( false );
+}
+
+MeshGeometry::~MeshGeometry()
+{
+  clear();
+  delete vertex_data_;
+}
+
+void MeshGeometry::clear()
+{
+  Ogre::SceneManager* scene_manager = parent_node_->getCreator();
+  for( size_t i = 0; i < chunks_.size(); i++ )
+  {
+    chunk_nodes_[i]->detachAllObjects();
+    scene_manager->destroySceneNode( chunk_nodes_[i] );
+    delete chunks_[i];
+  }
+  chunks_.clear();
+  chunk_nodes_.clear();
+
+  vertex_data_->vertexBufferBinding->unsetAllBindings();
+  vertex_data_->vertexCount = 0;
+
+  vertex_buffer_.setNull();
+  index_buffer_.setNull();
+  lod_buffers_.clear();
+  vertex_count_ = 0;
+  index_count_ = 0;
+  dynamic_ = false;
+}
+
+void MeshGeometry::setLayout( bool compact )
+{
+  if( compact )
+    CompactVertexLayout::declare( vertex_data_->vertexDeclaration );
+  else
+    FloatVertexLayout::declare( vertex_data_->vertexDeclaration );
+  compact_ = compact;
+}
+
+void MeshGeometry::setMaterial( const std::string& material_name )
+{
+  material_name_ = material_name;
+  for( size_t i = 0; i < chunks_.size(); i++ )
+    chunks_[i]->setMaterial( material_name_ );
+}
+
+Ogre::AxisAlignedBox MeshGeometry::getWorldBoundingBox() const
+{
+  Ogre::AxisAlignedBox bounds;
+  for( size_t i = 0; i < chunks_.size(); i++ )
+    bounds.merge( chunks_[i]->getWorldBoundingBox( true ));
+  return bounds;
+}
+
+void MeshGeometry::setGeometry( const MeshBuffer& buffer )
+{
+  size_t vertex_count = buffer.vertex_count;
+  size_t index_count = buffer.getIndexCount();
+  if( buffer.lod_only )
+  {
+    if( !vertex_buffer_.isNull() && vertex_count == vertex_count_ )
+      setLods( buffer );
+    return;
+  }
+
+  if( buffer.vertices_only && !vertex_buffer_.isNull() && vertex_count == vertex_count_ && buffer.compact == compact_ )
+  {
+    updateVertices( buffer );
+    setChunkBounds( buffer );
+    // the simplified levels reference the same vertices, so they stay valid
+    if( !buffer.lod_indices.empty() )
+      setLods( buffer );
+    return;
+  }
+
+  if( vertex_count == 0 || index_count == 0 )
+  {
+    clear();
+    return;
+  }
+
+  if( buffer.compact != compact_ )
+  {
+    setLayout( buffer.compact );
+    vertex_buffer_.setNull();
+  }
+
+  Ogre::HardwareBufferManager& buffer_manager = Ogre::HardwareBufferManager::getSingleton();
+  size_t vertex_size = vertex_data_->vertexDeclaration->getVertexSize( 0 );
+
+  // only reallocate when the mesh grows, otherwise overwrite the existing buffer
+  if( vertex_buffer_.isNull() || vertex_buffer_->getNumVertices() < vertex_count )
+  {
+    vertex_buffer_ = buffer_manager.createVertexBuffer( vertex_size, vertex_count,
+                                                        dynamic_ ? Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY
+                                                                 : Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+    vertex_data_->vertexBufferBinding->setBinding( 0, vertex_buffer_ );
+  }
+  vertex_buffer_->writeData( 0, vertex_count * vertex_size, getVertices( buffer, 0 ), vertex_buffer_->getNumVertices() == vertex_count );
+  vertex_data_->vertexCount = vertex_count;
+
+  Ogre::HardwareIndexBuffer::IndexType index_type = buffer.uses32BitIndices() ? Ogre::HardwareIndexBuffer::IT_32BIT
+                                                                              : Ogre::HardwareIndexBuffer::IT_16BIT;
+  if( index_buffer_.isNull() || index_buffer_->getType() != index_type || index_buffer_->getNumIndexes() < index_count )
+  {
+    index_buffer_ = buffer_manager.createIndexBuffer( index_type, index_count,
+                                                      Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+  }
+  writeIndices( index_buffer_, buffer.indices );
+
+  vertex_count_ = vertex_count;
+  index_count_ = index_count;
+
+  setChunks( buffer );
+  setLods( buffer );
+}
+
+void MeshGeometry::updateVertices( const MeshBuffer& buffer )
+{
+  size_t vertex_size = vertex_data_->vertexDeclaration->getVertexSize( 0 );
+
+  size_t dirty_count = 0;
+  for( size_t i = 0; i < buffer.dirty_ranges.size(); i++ )
+    dirty_count += buffer.dirty_ranges[i].second;
+
+  if( !dynamic_ )
+  {
+    // the mesh is being deformed, move it to a dynamic buffer and upload everything once
+    dynamic_ = true;
+    vertex_buffer_ = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer( vertex_size, vertex_count_,
+                                                                                     Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY );
+    vertex_data_->vertexBufferBinding->setBinding( 0, vertex_buffer_ );
+    dirty_count = vertex_count_;
+  }
+
+  if( dirty_count * 2 > vertex_count_ )
+  {
+    // most of the mesh moved, cheaper to discard the whole buffer than to wait for the GPU
+    void* data = vertex_buffer_->lock( 0, vertex_count_ * vertex_size, Ogre::HardwareBuffer::HBL_DISCARD );
+    memcpy( data, getVertices( buffer, 0 ), vertex_count_ * vertex_size );
+    vertex_buffer_->unlock();
+  }
+  else
+  {
+    for( size_t i = 0; i < buffer.dirty_ranges.size(); i++ )
+    {
+      size_t first = buffer.dirty_ranges[i].first;
+      size_t count = buffer.dirty_ranges[i].second;
+      vertex_buffer_->writeData( first * vertex_size, count * vertex_size, getVertices( buffer, first ));
+    }
+  }
+}
+
+const void* MeshGeometry::getVertices( const MeshBuffer& buffer, size_t first )
+{
+  if( buffer.compact )
+    return &buffer.compact_vertices[first * MeshBuffer::SHORTS_PER_COMPACT_VERTEX];
+  return &buffer.vertices[first * MeshBuffer::FLOATS_PER_VERTEX];
+}
+
+void MeshGeometry::setChunks( const MeshBuffer& buffer )
+{
+  Ogre::SceneManager* scene_manager = parent_node_->getCreator();
+
+  // buffers without a chunk layout are drawn as a single chunk
+  size_t chunk_count = std::max<size_t>( buffer.chunks.size(), 1 );
+  while( chunks_.size() > chunk_count )
+  {
+    chunk_nodes_.back()->detachAllObjects();
+    scene_manager->destroySceneNode( chunk_nodes_.back() );
+    delete chunks_.back();
+    chunk_nodes_.pop_back();
+    chunks_.pop_back();
+  }
+  while( chunks_.size() < chunk_count )
+  {
+    MeshRenderable* chunk = new MeshRenderable( vertex_data_ );
+    if( !material_name_.empty() )
+      chunk->setMaterial( material_name_ );
+    Ogre::SceneNode* node = parent_node_->createChildSceneNode();
+    node->attachObject( chunk );
+    chunks_.push_back( chunk );
+    chunk_nodes_.push_back( node );
+  }
+
+  for( size_t i = 0; i < chunks_.size(); i++ )
+  {
+    if( buffer.chunks.empty() )
+      chunks_[i]->setIndices( index_buffer_, 0, index_count_ );
+    else
+      chunks_[i]->setIndices( index_buffer_, buffer.chunks[i].index_start, buffer.chunks[i].index_count );
+  }
+
+  setChunkBounds( buffer );
+}
+
+void MeshGeometry::setChunkBounds( const MeshBuffer& buffer )
+{
+  for( size_t i = 0; i < chunks_.size(); i++ )
+  {
+    chunks_[i]->setBounds( buffer.chunks.size() == chunks_.size() ? buffer.chunks[i].bounds : buffer.bounds );
+
+    // read by the compact vertex programs
+    chunks_[i]->setCustomParameter( QUANTIZE_OFFSET_PARAMETER, Ogre::Vector4( buffer.quantize_offset.x, buffer.quantize_offset.y, buffer.quantize_offset.z, 0.0f ));
+    chunks_[i]->setCustomParameter( QUANTIZE_SCALE_PARAMETER, Ogre::Vector4( buffer.quantize_scale.x, buffer.quantize_scale.y, buffer.quantize_scale.z, 0.0f ));
+  }
+}
+
+void MeshGeometry::setLods( const MeshBuffer& buffer )
+{
+  lod_buffers_.clear();
+  for( size_t i = 0; i < chunks_.size(); i++ )
+    chunks_[i]->clearLods();
+
+  Ogre::HardwareIndexBuffer::IndexType index_type = buffer.uses32BitIndices() ? Ogre::HardwareIndexBuffer::IT_32BIT
+                                                                              : Ogre::HardwareIndexBuffer::IT_16BIT;
+  for( size_t level = 0; level < buffer.lod_indices.size(); level++ )
+  {
+    const std::vector<uint32_t>& indices = buffer.lod_indices[level];
+    if( indices.empty() )
+      break;
+
+    Ogre::HardwareIndexBufferSharedPtr lod_buffer =
+        Ogre::HardwareBufferManager::getSingleton().createIndexBuffer( index_type, indices.size(),
+                                                                      Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+    writeIndices( lod_buffer, indices );
+    lod_buffers_.push_back( lod_buffer );
+
+    if( level >= buffer.lod_chunk_ranges.size() || buffer.lod_chunk_ranges[level].size() != chunks_.size() )
+    {
+      if( chunks_.size() == 1 )
+        chunks_[0]->addLod( lod_buffer, 0, indices.size() );
+      continue;
+    }
+
+    for( size_t i = 0; i < chunks_.size(); i++ )
+    {
+      // a chunk that simplified away completely keeps its last non-empty level
+      const std::pair<size_t, size_t>& range = buffer.lod_chunk_ranges[level][i];
+      if( range.second > 0 && chunks_[i]->getLodCount() == level )
+        chunks_[i]->addLod( lod_buffer, range.first, range.second );
+    }
+  }
+}
+
+} // namespace rviz
@@ -0,0 +1,125 @@
+/*
+ * MeshGeometry declaration.
+ *
+ * Hardware buffers and spatial chunks of the mesh drawn by MeshDisplayCustom.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_MESH_GEOMETRY_H
+#define RVIZ_MESH_GEOMETRY_H
+
+#include <OGRE/OgreHardwareVertexBuffer.h>
+#include <OGRE/OgreHardwareIndexBuffer.h>
+#include <OGRE/OgreAxisAlignedBox.h>
+
+#include <string>
+#include <vector>
+
+#include "mesh_buffer.h"
+
+namespace Ogre
+{
+class SceneNode;
+class VertexData;
+}
+
+namespace rviz
+{
+
+class MeshRenderable;
+
+/**
+ * \class MeshGeometry
+ * \brief Owns the vertex and index buffers of a mesh and one MeshRenderable per spatial chunk.
+ *
+ * The mesh is uploaded once into a single vertex buffer (position + normal) and a single index
+ * buffer in which the triangles of every chunk are contiguous. Each chunk gets its own child scene
+ * node under parent_node so Ogre can frustum cull it on its own bounds.
+ *
+ * Compact buffers use 16 bit positions and octahedral normals instead of floats; the material has
+ * to decode them with the programs from compact_vertex_program.h.
+ */
+class MeshGeometry
+{
+public:
+  explicit MeshGeometry( Ogre::SceneNode* parent_node );
+  ~MeshGeometry();
+
+  // copies the packed buffer into the hardware buffers, reusing them when they are large enough;
+  // vertex-only buffers just rewrite their dirty ranges and lod-only buffers only add the levels
+  void setGeometry( const MeshBuffer& buffer );
+  void clear();
+
+  void setMaterial( const std::string& material_name );
+
+  size_t getVertexCount() const { return vertex_count_; }
+  size_t getIndexCount() const { return index_count_; }
+  size_t getChunkCount() const { return chunks_.size(); }
+  bool isCompact() const { return compact_; }
+
+  // union of the chunk bounds in world coordinates
+  Ogre::AxisAlignedBox getWorldBoundingBox() const;
+
+private:
+  void setLayout( bool compact );
+  void updateVertices( const MeshBuffer& buffer );
+  static const void* getVertices( const MeshBuffer& buffer, size_t first );
+  void setChunks( const MeshBuffer& buffer );
+  void setChunkBounds( const MeshBuffer& buffer );
+  void setLods( const MeshBuffer& buffer );
+
+  Ogre::SceneNode* parent_node_;
+
+  Ogre::VertexData* vertex_data_;
+  Ogre::HardwareVertexBufferSharedPtr vertex_buffer_;
+  Ogre::HardwareIndexBufferSharedPtr index_buffer_;
+  std::vector<Ogre::HardwareIndexBufferSharedPtr> lod_buffers_;
+
+  std::vector<MeshRenderable*> chunks_;
+  std::vector<Ogre::SceneNode*> chunk_nodes_;
+
+  std::string material_name_;
+
+  size_t vertex_count_;
+  size_t index_count_;
+
+  // switched on by the first vertex-only update, so deforming meshes get a dynamic vertex buffer
+  bool dynamic_;
+  bool compact_;
+};
+
+} // namespace rviz
+
+#endif
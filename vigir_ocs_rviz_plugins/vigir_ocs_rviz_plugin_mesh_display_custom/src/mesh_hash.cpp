@@ -0,0 +1,97 @@
+/*
+ * Content hash.
+ *
+ * Fast non-cryptographic hash used to fingerprint meshes and mesh files.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <string.h>
+
+#include "mesh_hash.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+const uint64_t HASH_PRIME1 = 0x9E3779B185EBCA87ULL;
+const uint64_t HASH_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t HASH_PRIME3 = 0x165667B19E3779F9ULL;
+
+inline uint64_t rotate( uint64_t x, int bits )
+{
+  return ( x << bits ) | ( x >> ( 64 - bits ));
+}
+
+inline uint64_t readWord( const unsigned char* data )
+{
+  uint64_t word;
+  memcpy( &word, data, sizeof(word) );
+  return word;
+}
+
+} // namespace
+
+// multiply-rotate hash over raw bytes; the four lanes are independent so the multiplies of
+// consecutive words overlap instead of waiting on each other like in a single-state hash
+uint64_t hashBytes( const void* bytes, size_t size, uint64_t seed )
+{
+  const unsigned char* data = static_cast<const unsigned char*>( bytes );
+  uint64_t lanes[4] = { seed + HASH_PRIME1 + HASH_PRIME2, seed + HASH_PRIME2, seed, seed - HASH_PRIME1 };
+
+  size_t i = 0;
+  for( ; i + 32 <= size; i += 32 )
+  {
+    for( int l = 0; l < 4; l++ )
+      lanes[l] = rotate( lanes[l] + readWord( data + i + l*8 ) * HASH_PRIME2, 31 ) * HASH_PRIME1;
+  }
+
+  uint64_t hash = rotate( lanes[0], 1 ) + rotate( lanes[1], 7 ) + rotate( lanes[2], 12 ) + rotate( lanes[3], 18 );
+  hash += size;
+  for( ; i + 8 <= size; i += 8 )
+    hash = rotate( hash ^ ( readWord( data + i ) * HASH_PRIME2 ), 27 ) * HASH_PRIME1 + HASH_PRIME3;
+  for( ; i < size; i++ )
+    hash = rotate( hash ^ ( data[i] * HASH_PRIME3 ), 11 ) * HASH_PRIME1;
+
+  hash ^= hash >> 33;
+  hash *= HASH_PRIME2;
+  hash ^= hash >> 29;
+  hash *= HASH_PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+} // namespace rviz
@@ -0,0 +1,150 @@
+/*
+ * MeshRenderable class implementation.
+ *
+ * One spatial chunk of the indexed geometry used by MeshDisplayCustom.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <OGRE/OgreCamera.h>
+#include <OGRE/OgreSceneNode.h>
+
+#include "mesh_renderable.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// the first simplified level is used beyond this many bounding radii, every further level at twice the distance
+const Ogre::Real LOD_START_DISTANCE = 2.0f;
+
+} // namespace
+
+MeshRenderable::MeshRenderable( Ogre::VertexData* vertex_data )
+  : bounding_radius_( 0.0f )
+{
+  mRenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
+  mRenderOp.useIndexes = true;
+  mRenderOp.vertexData = vertex_data;
+
+  index_data_ = new Ogre::IndexData();
+  index_data_->indexStart = 0;
+  index_data_->indexCount = 0;
+  mRenderOp.indexData = index_data_;
+}
+
+MeshRenderable::~MeshRenderable()
+{
+  clearLods();
+  delete index_data_;
+}
+
+void MeshRenderable::setIndices( const Ogre::HardwareIndexBufferSharedPtr& buffer, size_t start, size_t count )
+{
+  index_data_->indexBuffer = buffer;
+  index_data_->indexStart = start;
+  index_data_->indexCount = count;
+}
+
+void MeshRenderable::addLod( const Ogre::HardwareIndexBufferSharedPtr& buffer, size_t start, size_t count )
+{
+  Ogre::IndexData* index_data = new Ogre::IndexData();
+  index_data->indexBuffer = buffer;
+  index_data->indexStart = start;
+  index_data->indexCount = count;
+  lod_index_data_.push_back( index_data );
+}
+
+void MeshRenderable::clearLods()
+{
+  mRenderOp.indexData = index_data_;
+  for( size_t i = 0; i < lod_index_data_.size(); i++ )
+    delete lod_index_data_[i];
+  lod_index_data_.clear();
+}
+
+void MeshRenderable::setBounds( const Ogre::AxisAlignedBox& bounds )
+{
+  setBoundingBox( bounds );
+  bounding_radius_ = bounds.isFinite() ? bounds.getHalfSize().length() : 0.0f;
+
+  // let the scene graph know our bounds changed
+  if( mParentNode )
+  {
+    mParentNode->needUpdate();
+  }
+}
+
+void MeshRenderable::_notifyCurrentCamera( Ogre::Camera* cam )
+{
+  Ogre::SimpleRenderable::_notifyCurrentCamera( cam );
+
+  mRenderOp.indexData = index_data_;
+  if( lod_index_data_.empty() || !mBox.isFinite() )
+    return;
+
+  // distance from the camera to the closest point of the chunk, in bounding radii
+  const Ogre::AxisAlignedBox& box = getWorldBoundingBox( true );
+  Ogre::Vector3 eye = cam->getDerivedPosition();
+  Ogre::Vector3 closest = eye;
+  closest.makeCeil( box.getMinimum() );
+  closest.makeFloor( box.getMaximum() );
+  Ogre::Real radius = box.getHalfSize().length();
+  if( radius <= 0.0f )
+    return;
+  Ogre::Real distance = eye.distance( closest ) / ( radius * cam->_getLodBiasInverse() );
+
+  size_t level = 0;
+  for( Ogre::Real threshold = LOD_START_DISTANCE; level < lod_index_data_.size() && distance > threshold; threshold *= 2.0f )
+    level++;
+
+  if( level > 0 )
+    mRenderOp.indexData = lod_index_data_[level-1];
+}
+
+Ogre::Real MeshRenderable::getSquaredViewDepth( const Ogre::Camera* cam ) const
+{
+  Ogre::Vector3 center = mBox.isFinite() ? mBox.getCenter() : Ogre::Vector3::ZERO;
+  Ogre::Vector3 world_center = mParentNode ? mParentNode->_getFullTransform() * center : center;
+  return ( world_center - cam->getDerivedPosition() ).squaredLength();
+}
+
+Ogre::Real MeshRenderable::getBoundingRadius() const
+{
+  return bounding_radius_;
+}
+
+} // namespace rviz
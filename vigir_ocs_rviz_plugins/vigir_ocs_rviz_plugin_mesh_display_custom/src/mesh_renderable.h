@@ -0,0 +1,97 @@
+/*
+ * MeshRenderable declaration.
+ *
+ * One spatial chunk of the indexed geometry used by MeshDisplayCustom.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_MESH_RENDERABLE_H
+#define RVIZ_MESH_RENDERABLE_H
+
+#include <OGRE/OgreSimpleRenderable.h>
+#include <OGRE/OgreHardwareIndexBuffer.h>
+#include <OGRE/OgreAxisAlignedBox.h>
+
+#include <vector>
+
+namespace rviz
+{
+
+/**
+ * \class MeshRenderable
+ * \brief Renders a range of triangles out of vertex and index buffers owned by MeshGeometry.
+ *
+ * Every spatial chunk of a mesh is one MeshRenderable on its own scene node, so chunks outside
+ * the view frustum are culled by Ogre. All chunks draw from the same vertex data; both sides of the
+ * triangles are drawn by disabling culling in the material.
+ *
+ * Ranges in the simplified index buffers can be added as levels of detail, they are swapped in per
+ * camera depending on the distance to the chunk.
+ */
+class MeshRenderable : public Ogre::SimpleRenderable
+{
+public:
+  // vertex_data is shared between all chunks and not owned by the renderable
+  explicit MeshRenderable( Ogre::VertexData* vertex_data );
+  virtual ~MeshRenderable();
+
+  // full resolution triangles of this chunk
+  void setIndices( const Ogre::HardwareIndexBufferSharedPtr& buffer, size_t start, size_t count );
+
+  // appends the next coarser level of detail
+  void addLod( const Ogre::HardwareIndexBufferSharedPtr& buffer, size_t start, size_t count );
+  void clearLods();
+
+  void setBounds( const Ogre::AxisAlignedBox& bounds );
+
+  size_t getIndexCount() const { return index_data_->indexCount; }
+  size_t getLodCount() const { return lod_index_data_.size(); }
+
+  // Overrides from SimpleRenderable
+  virtual Ogre::Real getSquaredViewDepth( const Ogre::Camera* cam ) const;
+  virtual Ogre::Real getBoundingRadius() const;
+  virtual void _notifyCurrentCamera( Ogre::Camera* cam );
+
+private:
+  // full resolution indices; mRenderOp.indexData points either here or to one of the levels
+  Ogre::IndexData* index_data_;
+  std::vector<Ogre::IndexData*> lod_index_data_;
+
+  Ogre::Real bounding_radius_;
+};
+
+} // namespace rviz
+
+#endif
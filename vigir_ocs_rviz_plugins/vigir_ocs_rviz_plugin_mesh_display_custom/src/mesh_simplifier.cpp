@@ -0,0 +1,407 @@
+/*
+ * Mesh simplification.
+ *
+ * Quadric error metric decimation used to build mesh LOD levels.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <math.h>
+
+#include "mesh_simplifier.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// border edges are held in place by planes weighted this much more than the surface
+const double BOUNDARY_WEIGHT = 100.0;
+
+struct Vec3
+{
+  Vec3() : x( 0 ), y( 0 ), z( 0 ) {}
+  Vec3( double x, double y, double z ) : x( x ), y( y ), z( z ) {}
+
+  Vec3 operator-( const Vec3& o ) const { return Vec3( x-o.x, y-o.y, z-o.z ); }
+  double dot( const Vec3& o ) const { return x*o.x + y*o.y + z*o.z; }
+  Vec3 cross( const Vec3& o ) const { return Vec3( y*o.z - z*o.y, z*o.x - x*o.z, x*o.y - y*o.x ); }
+  double length() const { return sqrt( dot( *this )); }
+
+  double x, y, z;
+};
+
+// symmetric 4x4 matrix of the plane equations around a vertex
+struct Quadric
+{
+  Quadric()
+  {
+    std::fill( m, m + 10, 0.0 );
+  }
+
+  Quadric( double a, double b, double c, double d, double weight )
+  {
+    m[0] = weight*a*a; m[1] = weight*a*b; m[2] = weight*a*c; m[3] = weight*a*d;
+    m[4] = weight*b*b; m[5] = weight*b*c; m[6] = weight*b*d;
+    m[7] = weight*c*c; m[8] = weight*c*d;
+    m[9] = weight*d*d;
+  }
+
+  Quadric& operator+=( const Quadric& o )
+  {
+    for( int i = 0; i < 10; i++ )
+      m[i] += o.m[i];
+    return *this;
+  }
+
+  // squared distance to the accumulated planes
+  double evaluate( const Vec3& v ) const
+  {
+    return m[0]*v.x*v.x + 2*m[1]*v.x*v.y + 2*m[2]*v.x*v.z + 2*m[3]*v.x
+         + m[4]*v.y*v.y + 2*m[5]*v.y*v.z + 2*m[6]*v.y
+         + m[7]*v.z*v.z + 2*m[8]*v.z
+         + m[9];
+  }
+
+  double m[10];
+};
+
+struct Collapse
+{
+  double cost;
+  uint32_t from;
+  uint32_t to;
+  uint32_t from_version;
+  uint32_t to_version;
+
+  bool operator>( const Collapse& o ) const { return cost > o.cost; }
+};
+
+class Simplifier
+{
+public:
+  Simplifier( const float* positions, size_t stride, size_t vertex_count, const std::vector<uint32_t>& indices,
+              const std::vector<bool>& locked )
+    : positions_( vertex_count )
+    , quadrics_( vertex_count )
+    , vertex_triangles_( vertex_count )
+    , version_( vertex_count, 0 )
+    , removed_vertex_( vertex_count, false )
+    , locked_( locked )
+    , triangles_( indices )
+    , removed_triangle_( indices.size() / 3, false )
+    , live_triangles_( indices.size() / 3 )
+  {
+    triangles_.resize( live_triangles_ * 3 );
+    for( size_t i = 0; i < vertex_count; i++ )
+      positions_[i] = Vec3( positions[i*stride], positions[i*stride+1], positions[i*stride+2] );
+
+    for( size_t t = 0; t < live_triangles_; t++ )
+    {
+      const uint32_t* tri = &triangles_[t*3];
+      for( int c = 0; c < 3; c++ )
+        vertex_triangles_[tri[c]].push_back( t );
+
+      Vec3 normal = faceNormal( tri[0], tri[1], tri[2] );
+      double area2 = normal.length();
+      if( area2 <= 0.0 )
+        continue;
+      normal = Vec3( normal.x/area2, normal.y/area2, normal.z/area2 );
+
+      Quadric plane( normal.x, normal.y, normal.z, -normal.dot( positions_[tri[0]] ), area2 * 0.5 );
+      for( int c = 0; c < 3; c++ )
+        quadrics_[tri[c]] += plane;
+    }
+
+    addBoundaryConstraints();
+
+    std::vector<std::pair<uint32_t, uint32_t> > edges;
+    collectEdges( edges, false );
+    for( size_t i = 0; i < edges.size(); i++ )
+      pushCollapse( edges[i].first, edges[i].second );
+  }
+
+  void run( size_t target_triangles )
+  {
+    while( live_triangles_ > target_triangles && !heap_.empty() )
+    {
+      Collapse collapse = heap_.top();
+      heap_.pop();
+
+      if( removed_vertex_[collapse.from] || removed_vertex_[collapse.to] ||
+          version_[collapse.from] != collapse.from_version || version_[collapse.to] != collapse.to_version )
+        continue;
+
+      if( flips( collapse.from, collapse.to ))
+        continue;
+
+      apply( collapse.from, collapse.to );
+    }
+  }
+
+  void getTriangles( std::vector<uint32_t>& result ) const
+  {
+    result.clear();
+    result.reserve( live_triangles_ * 3 );
+    for( size_t t = 0; t < removed_triangle_.size(); t++ )
+    {
+      if( !removed_triangle_[t] )
+        result.insert( result.end(), triangles_.begin() + t*3, triangles_.begin() + t*3 + 3 );
+    }
+  }
+
+private:
+  Vec3 faceNormal( uint32_t a, uint32_t b, uint32_t c ) const
+  {
+    return ( positions_[b] - positions_[a] ).cross( positions_[c] - positions_[a] );
+  }
+
+  // unique edges as (low, high) vertex pairs, optionally only those used by a single triangle
+  void collectEdges( std::vector<std::pair<uint32_t, uint32_t> >& edges, bool boundary_only ) const
+  {
+    std::vector<std::pair<uint32_t, uint32_t> > all;
+    all.reserve( triangles_.size() );
+    for( size_t t = 0; t < removed_triangle_.size(); t++ )
+    {
+      const uint32_t* tri = &triangles_[t*3];
+      for( int c = 0; c < 3; c++ )
+      {
+        uint32_t a = tri[c], b = tri[(c+1)%3];
+        if( a != b )
+          all.push_back( std::make_pair( std::min( a, b ), std::max( a, b )));
+      }
+    }
+    std::sort( all.begin(), all.end() );
+
+    edges.clear();
+    for( size_t i = 0; i < all.size(); )
+    {
+      size_t j = i + 1;
+      while( j < all.size() && all[j] == all[i] )
+        j++;
+      if( !boundary_only || j - i == 1 )
+        edges.push_back( all[i] );
+      i = j;
+    }
+  }
+
+  void addBoundaryConstraints()
+  {
+    std::vector<std::pair<uint32_t, uint32_t> > boundary;
+    collectEdges( boundary, true );
+
+    for( size_t i = 0; i < boundary.size(); i++ )
+    {
+      uint32_t a = boundary[i].first, b = boundary[i].second;
+
+      // the triangle owning the edge gives the surface normal
+      const std::vector<uint32_t>& candidates = vertex_triangles_[a];
+      for( size_t k = 0; k < candidates.size(); k++ )
+      {
+        const uint32_t* tri = &triangles_[candidates[k]*3];
+        if( tri[0] != b && tri[1] != b && tri[2] != b )
+          continue;
+
+        Vec3 edge = positions_[b] - positions_[a];
+        Vec3 normal = faceNormal( tri[0], tri[1], tri[2] );
+        Vec3 plane = edge.cross( normal );
+        double length = plane.length();
+        if( length > 0.0 )
+        {
+          plane = Vec3( plane.x/length, plane.y/length, plane.z/length );
+          Quadric constraint( plane.x, plane.y, plane.z, -plane.dot( positions_[a] ), BOUNDARY_WEIGHT * edge.dot( edge ));
+          quadrics_[a] += constraint;
+          quadrics_[b] += constraint;
+        }
+        break;
+      }
+    }
+  }
+
+  bool isLocked( uint32_t v ) const
+  {
+    return v < locked_.size() && locked_[v];
+  }
+
+  void pushCollapse( uint32_t a, uint32_t b )
+  {
+    bool locked_a = isLocked( a );
+    bool locked_b = isLocked( b );
+    if( locked_a && locked_b )
+      return;
+
+    Quadric q = quadrics_[a];
+    q += quadrics_[b];
+
+    Collapse collapse;
+    double cost_ab = q.evaluate( positions_[b] );
+    double cost_ba = q.evaluate( positions_[a] );
+    if( !locked_a && ( locked_b || cost_ab <= cost_ba ))
+    {
+      collapse.cost = cost_ab;
+      collapse.from = a;
+      collapse.to = b;
+    }
+    else
+    {
+      collapse.cost = cost_ba;
+      collapse.from = b;
+      collapse.to = a;
+    }
+    collapse.from_version = version_[collapse.from];
+    collapse.to_version = version_[collapse.to];
+    heap_.push( collapse );
+  }
+
+  // true if moving from onto to would turn any remaining triangle of from upside down
+  bool flips( uint32_t from, uint32_t to ) const
+  {
+    const std::vector<uint32_t>& tris = vertex_triangles_[from];
+    for( size_t k = 0; k < tris.size(); k++ )
+    {
+      if( removed_triangle_[tris[k]] )
+        continue;
+
+      const uint32_t* tri = &triangles_[tris[k]*3];
+      if( tri[0] == to || tri[1] == to || tri[2] == to )
+        continue; // this one collapses away
+
+      uint32_t moved[3];
+      for( int c = 0; c < 3; c++ )
+        moved[c] = tri[c] == from ? to : tri[c];
+
+      Vec3 before = faceNormal( tri[0], tri[1], tri[2] );
+      Vec3 after = faceNormal( moved[0], moved[1], moved[2] );
+      if( before.dot( after ) <= 0.0 )
+        return true;
+    }
+    return false;
+  }
+
+  void apply( uint32_t from, uint32_t to )
+  {
+    std::vector<uint32_t>& from_tris = vertex_triangles_[from];
+    std::vector<uint32_t>& to_tris = vertex_triangles_[to];
+
+    for( size_t k = 0; k < from_tris.size(); k++ )
+    {
+      uint32_t t = from_tris[k];
+      if( removed_triangle_[t] )
+        continue;
+
+      uint32_t* tri = &triangles_[t*3];
+      if( tri[0] == to || tri[1] == to || tri[2] == to )
+      {
+        removed_triangle_[t] = true;
+        live_triangles_--;
+        continue;
+      }
+
+      for( int c = 0; c < 3; c++ )
+      {
+        if( tri[c] == from )
+          tri[c] = to;
+      }
+      to_tris.push_back( t );
+    }
+    from_tris.clear();
+
+    removed_vertex_[from] = true;
+    quadrics_[to] += quadrics_[from];
+    version_[to]++;
+
+    // drop dead triangles and requeue every edge around the merged vertex
+    std::vector<uint32_t> live;
+    live.reserve( to_tris.size() );
+    std::vector<uint32_t> neighbours;
+    for( size_t k = 0; k < to_tris.size(); k++ )
+    {
+      if( removed_triangle_[to_tris[k]] )
+        continue;
+      live.push_back( to_tris[k] );
+
+      const uint32_t* tri = &triangles_[to_tris[k]*3];
+      for( int c = 0; c < 3; c++ )
+      {
+        if( tri[c] != to )
+          neighbours.push_back( tri[c] );
+      }
+    }
+    to_tris.swap( live );
+
+    std::sort( neighbours.begin(), neighbours.end() );
+    neighbours.erase( std::unique( neighbours.begin(), neighbours.end() ), neighbours.end() );
+    for( size_t k = 0; k < neighbours.size(); k++ )
+      pushCollapse( to, neighbours[k] );
+  }
+
+  std::vector<Vec3> positions_;
+  std::vector<Quadric> quadrics_;
+  std::vector<std::vector<uint32_t> > vertex_triangles_;
+  std::vector<uint32_t> version_;
+  std::vector<bool> removed_vertex_;
+  // empty if no vertex is locked
+  const std::vector<bool>& locked_;
+
+  std::vector<uint32_t> triangles_;
+  std::vector<bool> removed_triangle_;
+  size_t live_triangles_;
+
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse> > heap_;
+};
+
+} // namespace
+
+void simplifyMesh( const float* positions, size_t stride, size_t vertex_count,
+                   const std::vector<uint32_t>& indices, size_t target_triangles,
+                   std::vector<uint32_t>& result )
+{
+  simplifyMesh( positions, stride, vertex_count, indices, target_triangles, std::vector<bool>(), result );
+}
+
+void simplifyMesh( const float* positions, size_t stride, size_t vertex_count,
+                   const std::vector<uint32_t>& indices, size_t target_triangles,
+                   const std::vector<bool>& locked, std::vector<uint32_t>& result )
+{
+  Simplifier simplifier( positions, stride, vertex_count, indices, locked );
+  simplifier.run( target_triangles );
+  simplifier.getTriangles( result );
+}
+
+} // namespace rviz
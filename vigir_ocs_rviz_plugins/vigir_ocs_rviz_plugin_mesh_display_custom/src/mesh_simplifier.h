@@ -0,0 +1,75 @@
+/*
+ * Mesh simplification.
+ *
+ * Quadric error metric decimation used to build mesh LOD levels.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_MESH_SIMPLIFIER_H
+#define RVIZ_MESH_SIMPLIFIER_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace rviz
+{
+
+/**
+ * Simplifies an indexed triangle mesh with quadric error metric edge collapses (Garland and
+ * Heckbert, 1997) until at most target_triangles remain or no collapse is possible.
+ *
+ * Edges are only collapsed onto one of their end points, so the simplified triangles index the
+ * original vertices and every level of detail can share one vertex buffer. Collapses that would
+ * flip a triangle are rejected and open borders are kept in place by constraint planes.
+ *
+ * positions holds x,y,z at the start of every vertex, stride floats apart.
+ */
+void simplifyMesh( const float* positions, size_t stride, size_t vertex_count,
+                   const std::vector<uint32_t>& indices, size_t target_triangles,
+                   std::vector<uint32_t>& result );
+
+/**
+ * Same as above, but vertices flagged in locked never move: other vertices may collapse onto
+ * them, they never collapse themselves. Parts of a mesh simplified separately still meet along
+ * their locked shared vertices.
+ */
+void simplifyMesh( const float* positions, size_t stride, size_t vertex_count,
+                   const std::vector<uint32_t>& indices, size_t target_triangles,
+                   const std::vector<bool>& locked, std::vector<uint32_t>& result );
+
+} // namespace rviz
+
+#endif
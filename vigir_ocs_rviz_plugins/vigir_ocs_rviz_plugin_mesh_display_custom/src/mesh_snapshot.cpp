@@ -0,0 +1,379 @@
+/*
+ * Mesh snapshot files.
+ *
+ * Saves the render-ready buffers of MeshDisplayCustom so they can be shown right after a restart.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include "mapped_file.h"
+#include "mesh_snapshot.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+const char SNAPSHOT_MAGIC[8] = { 'V', 'O', 'C', 'S', 'S', 'N', 'P', '2' };
+
+class SnapshotWriter
+{
+public:
+  explicit SnapshotWriter( FILE* file )
+    : file_( file )
+    , ok_( file != NULL )
+  {}
+
+  bool ok() const { return ok_; }
+
+  void write( const void* data, size_t size )
+  {
+    if( ok_ && size > 0 )
+      ok_ = fwrite( data, size, 1, file_ ) == 1;
+  }
+
+  template<typename T>
+  void writeValue( T value )
+  {
+    write( &value, sizeof(T) );
+  }
+
+  template<typename T>
+  void writeArray( const std::vector<T>& array )
+  {
+    writeValue<uint64_t>( array.size() );
+    if( !array.empty() )
+      write( &array[0], array.size() * sizeof(T) );
+  }
+
+  void writeBox( const Ogre::AxisAlignedBox& box )
+  {
+    writeValue<uint8_t>( box.isFinite() ? 1 : 0 );
+    Ogre::Vector3 minimum = box.isFinite() ? box.getMinimum() : Ogre::Vector3::ZERO;
+    Ogre::Vector3 maximum = box.isFinite() ? box.getMaximum() : Ogre::Vector3::ZERO;
+    write( &minimum.x, 3*sizeof(float) );
+    write( &maximum.x, 3*sizeof(float) );
+  }
+
+private:
+  FILE* file_;
+  bool ok_;
+};
+
+class SnapshotReader
+{
+public:
+  SnapshotReader( const unsigned char* data, size_t size )
+    : data_( data )
+    , end_( data + size )
+    , ok_( data != NULL )
+  {}
+
+  bool ok() const { return ok_; }
+
+  void read( void* data, size_t size )
+  {
+    if( !ok_ || (size_t)( end_ - data_ ) < size )
+    {
+      ok_ = false;
+      return;
+    }
+    memcpy( data, data_, size );
+    data_ += size;
+  }
+
+  template<typename T>
+  T readValue()
+  {
+    T value = T();
+    read( &value, sizeof(T) );
+    return value;
+  }
+
+  template<typename T>
+  void readArray( std::vector<T>& array )
+  {
+    uint64_t count = readValue<uint64_t>();
+    // checked against the remaining bytes before allocating, a damaged count must not exhaust memory
+    if( !ok_ || count > (uint64_t)( end_ - data_ ) / sizeof(T) )
+    {
+      ok_ = false;
+      return;
+    }
+    array.resize( count );
+    if( count > 0 )
+      read( &array[0], count * sizeof(T) );
+  }
+
+  Ogre::AxisAlignedBox readBox()
+  {
+    bool finite = readValue<uint8_t>() != 0;
+    Ogre::Vector3 minimum, maximum;
+    read( &minimum.x, 3*sizeof(float) );
+    read( &maximum.x, 3*sizeof(float) );
+    Ogre::AxisAlignedBox box;
+    if( finite )
+      box.setExtents( minimum, maximum );
+    return box;
+  }
+
+private:
+  const unsigned char* data_;
+  const unsigned char* end_;
+  bool ok_;
+};
+
+typedef std::vector<std::vector<uint32_t> > LodIndices;
+typedef std::vector<std::vector<std::pair<size_t, size_t> > > LodChunkRanges;
+
+void writeBlock( SnapshotWriter& writer, const std::string& id, uint64_t fingerprint, const MeshBuffer& buffer,
+                 const LodIndices& lod_indices, const LodChunkRanges& lod_chunk_ranges )
+{
+  writer.writeArray( std::vector<char>( id.begin(), id.end() ));
+  writer.writeValue<uint64_t>( fingerprint );
+  writer.writeValue<uint8_t>( buffer.indexed );
+  writer.writeValue<uint8_t>( buffer.compact );
+  writer.writeValue<uint64_t>( buffer.vertex_count );
+  writer.writeValue<uint64_t>( buffer.triangle_count );
+  writer.writeValue<uint64_t>( buffer.invalid_triangles );
+  writer.writeValue<uint64_t>( buffer.topology_hash );
+  writer.writeBox( buffer.bounds );
+  writer.write( &buffer.quantize_offset.x, 3*sizeof(float) );
+  writer.write( &buffer.quantize_scale.x, 3*sizeof(float) );
+  writer.writeArray( buffer.vertices );
+  writer.writeArray( buffer.compact_vertices );
+  writer.writeArray( buffer.indices );
+
+  writer.writeValue<uint64_t>( buffer.chunks.size() );
+  for( size_t c = 0; c < buffer.chunks.size(); c++ )
+  {
+    writer.writeValue<uint64_t>( buffer.chunks[c].index_start );
+    writer.writeValue<uint64_t>( buffer.chunks[c].index_count );
+    writer.writeBox( buffer.chunks[c].bounds );
+  }
+
+  // ranges are stored per level, a level without chunks has none
+  writer.writeValue<uint64_t>( lod_indices.size() );
+  for( size_t level = 0; level < lod_indices.size(); level++ )
+  {
+    writer.writeArray( lod_indices[level] );
+    std::vector<uint64_t> ranges;
+    if( level < lod_chunk_ranges.size() )
+    {
+      for( size_t c = 0; c < lod_chunk_ranges[level].size(); c++ )
+      {
+        ranges.push_back( lod_chunk_ranges[level][c].first );
+        ranges.push_back( lod_chunk_ranges[level][c].second );
+      }
+    }
+    writer.writeArray( ranges );
+  }
+}
+
+// opens a temporary file next to path for writer; finishSnapshot renames it into place
+FILE* startSnapshot( const std::string& path, std::string& temp_path )
+{
+  std::string directory = path.substr( 0, path.rfind( '/' ));
+  if( !directory.empty() && !makeDirectories( directory ))
+    return NULL;
+
+  std::stringstream ss;
+  ss << path << "." << getpid() << ".tmp";
+  temp_path = ss.str();
+  return fopen( temp_path.c_str(), "wb" );
+}
+
+bool finishSnapshot( FILE* file, const SnapshotWriter& writer, const std::string& temp_path, const std::string& path )
+{
+  bool ok = writer.ok();
+  if( file != NULL )
+    ok = fclose( file ) == 0 && ok;
+  if( ok )
+    ok = rename( temp_path.c_str(), path.c_str() ) == 0;
+  if( !ok && !temp_path.empty() )
+    unlink( temp_path.c_str() );
+  return ok;
+}
+
+} // namespace
+
+bool writeMeshSnapshot( const std::string& path, const std::map<std::string, MeshBufferConstPtr>& buffers,
+                        const std::map<std::string, uint64_t>& fingerprints )
+{
+  std::string temp_path;
+  FILE* file = startSnapshot( path, temp_path );
+  SnapshotWriter writer( file );
+
+  writer.write( SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC) );
+  writer.writeValue<uint64_t>( buffers.size() );
+  std::map<std::string, MeshBufferConstPtr>::const_iterator it;
+  for( it = buffers.begin(); it != buffers.end(); ++it )
+  {
+    std::map<std::string, uint64_t>::const_iterator fingerprint = fingerprints.find( it->first );
+    writeBlock( writer, it->first, fingerprint != fingerprints.end() ? fingerprint->second : 0, *it->second,
+                it->second->lod_indices, it->second->lod_chunk_ranges );
+  }
+  return finishSnapshot( file, writer, temp_path, path );
+}
+
+bool writeMeshSnapshot( const std::string& path, const std::string& id, const MeshBuffer& buffer, uint64_t fingerprint,
+                        const std::vector<std::vector<uint32_t> >& lod_indices,
+                        const std::vector<std::vector<std::pair<size_t, size_t> > >& lod_chunk_ranges )
+{
+  std::string temp_path;
+  FILE* file = startSnapshot( path, temp_path );
+  SnapshotWriter writer( file );
+
+  writer.write( SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC) );
+  writer.writeValue<uint64_t>( 1 );
+  writeBlock( writer, id, fingerprint, buffer, lod_indices, lod_chunk_ranges );
+  return finishSnapshot( file, writer, temp_path, path );
+}
+
+bool readMeshSnapshot( const std::string& path, std::map<std::string, MeshBufferPtr>& buffers,
+                       std::map<std::string, uint64_t>& fingerprints )
+{
+  MappedFile file;
+  if( !file.open( path ))
+    return false;
+
+  SnapshotReader reader( file.getData(), file.getSize() );
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  reader.read( magic, sizeof(magic) );
+  if( !reader.ok() || memcmp( magic, SNAPSHOT_MAGIC, sizeof(magic) ) != 0 )
+    return false;
+
+  buffers.clear();
+  fingerprints.clear();
+  uint64_t block_count = reader.readValue<uint64_t>();
+  for( uint64_t b = 0; b < block_count && reader.ok(); b++ )
+  {
+    std::vector<char> id_chars;
+    reader.readArray( id_chars );
+    std::string id( id_chars.begin(), id_chars.end() );
+    fingerprints[id] = reader.readValue<uint64_t>();
+
+    MeshBufferPtr buffer( new MeshBuffer() );
+    buffer->indexed = reader.readValue<uint8_t>() != 0;
+    buffer->compact = reader.readValue<uint8_t>() != 0;
+    buffer->vertex_count = reader.readValue<uint64_t>();
+    buffer->triangle_count = reader.readValue<uint64_t>();
+    buffer->invalid_triangles = reader.readValue<uint64_t>();
+    buffer->topology_hash = reader.readValue<uint64_t>();
+    buffer->bounds = reader.readBox();
+    reader.read( &buffer->quantize_offset.x, 3*sizeof(float) );
+    reader.read( &buffer->quantize_scale.x, 3*sizeof(float) );
+    reader.readArray( buffer->vertices );
+    reader.readArray( buffer->compact_vertices );
+    reader.readArray( buffer->indices );
+
+    uint64_t chunk_count = reader.readValue<uint64_t>();
+    for( uint64_t c = 0; c < chunk_count && reader.ok(); c++ )
+    {
+      MeshChunk chunk;
+      chunk.index_start = reader.readValue<uint64_t>();
+      chunk.index_count = reader.readValue<uint64_t>();
+      chunk.bounds = reader.readBox();
+      buffer->chunks.push_back( chunk );
+    }
+
+    uint64_t level_count = reader.readValue<uint64_t>();
+    for( uint64_t level = 0; level < level_count && reader.ok(); level++ )
+    {
+      buffer->lod_indices.push_back( std::vector<uint32_t>() );
+      reader.readArray( buffer->lod_indices.back() );
+      std::vector<uint64_t> ranges;
+      reader.readArray( ranges );
+      if( ranges.empty() )
+        continue;
+      buffer->lod_chunk_ranges.resize( level + 1 );
+      for( size_t r = 0; r + 1 < ranges.size(); r += 2 )
+        buffer->lod_chunk_ranges[level].push_back( std::make_pair( (size_t)ranges[r], (size_t)ranges[r+1] ));
+    }
+
+    // never hand out indices or chunks that point outside of the arrays
+    bool consistent = buffer->vertices.size() == buffer->vertex_count * MeshBuffer::FLOATS_PER_VERTEX &&
+                      ( !buffer->compact || buffer->compact_vertices.size() == buffer->vertex_count * MeshBuffer::SHORTS_PER_COMPACT_VERTEX );
+    for( size_t i = 0; consistent && i < buffer->indices.size(); i++ )
+      consistent = buffer->indices[i] < buffer->vertex_count;
+    for( size_t c = 0; consistent && c < buffer->chunks.size(); c++ )
+      consistent = buffer->chunks[c].index_start + buffer->chunks[c].index_count <= buffer->indices.size();
+    for( size_t level = 0; consistent && level < buffer->lod_indices.size(); level++ )
+    {
+      const std::vector<uint32_t>& lod = buffer->lod_indices[level];
+      for( size_t i = 0; consistent && i < lod.size(); i++ )
+        consistent = lod[i] < buffer->vertex_count;
+    }
+    // levels are either drawn whole or have a range for every chunk
+    consistent = consistent && ( buffer->lod_chunk_ranges.empty() || buffer->lod_chunk_ranges.size() == buffer->lod_indices.size() );
+    for( size_t level = 0; consistent && level < buffer->lod_chunk_ranges.size(); level++ )
+    {
+      const std::vector<std::pair<size_t, size_t> >& ranges = buffer->lod_chunk_ranges[level];
+      consistent = ranges.size() == buffer->chunks.size();
+      for( size_t c = 0; consistent && c < ranges.size(); c++ )
+        consistent = ranges[c].first <= buffer->lod_indices[level].size() &&
+                     ranges[c].second <= buffer->lod_indices[level].size() - ranges[c].first;
+    }
+    if( !consistent )
+      return false;
+
+    buffers[id] = buffer;
+  }
+  return reader.ok();
+}
+
+std::string getSnapshotPath( const std::string& name )
+{
+  std::string ros_home = getRosHomeDirectory();
+  if( ros_home.empty() )
+    return ros_home;
+
+  std::string file_name = name;
+  for( size_t i = 0; i < file_name.size(); i++ )
+  {
+    char c = file_name[i];
+    if( !(( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' ) || c == '-' || c == '.' ))
+      file_name[i] = '_';
+  }
+  return ros_home + "/rviz_snapshots/" + file_name + ".snapshot";
+}
+
+} // namespace rviz
@@ -0,0 +1,75 @@
+/*
+ * Mesh snapshot files.
+ *
+ * Saves the render-ready buffers of MeshDisplayCustom so they can be shown right after a restart.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_MESH_SNAPSHOT_H
+#define RVIZ_MESH_SNAPSHOT_H
+
+#include <map>
+#include <string>
+
+#include "mesh_buffer.h"
+
+namespace rviz
+{
+
+/*
+ * A snapshot holds the full resolution buffers of every block together with the fingerprint of
+ * the mesh they were built from, and the levels of detail of the buffers that have them. Update
+ * flags are not stored. Writing goes through a temporary file that is renamed, so a crash never
+ * leaves a half written snapshot.
+ */
+
+bool writeMeshSnapshot( const std::string& path, const std::map<std::string, MeshBufferConstPtr>& buffers,
+                        const std::map<std::string, uint64_t>& fingerprints );
+
+// writes a snapshot of a single block whose levels of detail aren't attached to the buffer
+bool writeMeshSnapshot( const std::string& path, const std::string& id, const MeshBuffer& buffer, uint64_t fingerprint,
+                        const std::vector<std::vector<uint32_t> >& lod_indices,
+                        const std::vector<std::vector<std::pair<size_t, size_t> > >& lod_chunk_ranges );
+
+// returns false if the file is missing, from another version or damaged
+bool readMeshSnapshot( const std::string& path, std::map<std::string, MeshBufferPtr>& buffers,
+                       std::map<std::string, uint64_t>& fingerprints );
+
+// $ROS_HOME/rviz_snapshots/<name>.snapshot with name reduced to file name characters
+std::string getSnapshotPath( const std::string& name );
+
+} // namespace rviz
+
+#endif
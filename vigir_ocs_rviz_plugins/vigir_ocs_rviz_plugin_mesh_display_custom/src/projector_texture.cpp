@@ -0,0 +1,350 @@
+/*
+ * ProjectorTexture class implementation.
+ *
+ * Uploads camera images in their native pixel format for the mesh projector.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <OGRE/OgreTextureManager.h>
+#include <OGRE/OgreHardwarePixelBuffer.h>
+
+#include <ros/ros.h>
+#include <sensor_msgs/image_encodings.h>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+
+#include "rviz/image/ros_image_texture.h"
+
+#include "projector_texture.h"
+
+namespace rviz
+{
+
+namespace
+{
+
+// same mapping cv_bridge uses, OpenCV names bayer patterns by the second row
+int getBayerConversionCode( const std::string& encoding )
+{
+  namespace enc = sensor_msgs::image_encodings;
+  if( encoding == enc::BAYER_RGGB8 )
+    return CV_BayerBG2BGR;
+  if( encoding == enc::BAYER_BGGR8 )
+    return CV_BayerRG2BGR;
+  if( encoding == enc::BAYER_GBRG8 )
+    return CV_BayerGR2BGR;
+  if( encoding == enc::BAYER_GRBG8 )
+    return CV_BayerGB2BGR;
+  return -1;
+}
+
+// position x + 2*y of the red pixel in the 2x2 blocks of a bayer encoding
+int getBayerRed( const std::string& encoding )
+{
+  namespace enc = sensor_msgs::image_encodings;
+  if( encoding == enc::BAYER_RGGB8 )
+    return 0;
+  if( encoding == enc::BAYER_GRBG8 )
+    return 1;
+  if( encoding == enc::BAYER_GBRG8 )
+    return 2;
+  if( encoding == enc::BAYER_BGGR8 )
+    return 3;
+  return -1;
+}
+
+int getCvType( Ogre::PixelFormat format )
+{
+  switch( format )
+  {
+  case Ogre::PF_BYTE_RGB:
+  case Ogre::PF_BYTE_BGR:
+    return CV_8UC3;
+  case Ogre::PF_BYTE_RGBA:
+  case Ogre::PF_BYTE_BGRA:
+    return CV_8UC4;
+  case Ogre::PF_L16:
+    return CV_16UC1;
+  default:
+    return CV_8UC1;
+  }
+}
+
+const uint8_t BLANK_PIXEL[4] = { 255, 255, 255, 0 };
+
+} // namespace
+
+ProjectorTexture::ProjectorTexture()
+  : front_( 0 )
+  , ready_( -1 )
+  , downsample_( 1 )
+  , raw_bayer_( false )
+{
+  clear();
+}
+
+ProjectorTexture::~ProjectorTexture()
+{
+  for( int i = 0; i < NUM_SLOTS; i++ )
+  {
+    slots_[i].image.reset();
+    destroyTexture( slots_[i] );
+  }
+}
+
+void ProjectorTexture::addMessage( const sensor_msgs::Image::ConstPtr& image )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  pending_image_ = image;
+}
+
+void ProjectorTexture::clear()
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    pending_image_.reset();
+  }
+
+  // a single transparent pixel until the first image arrives
+  for( int i = 0; i < NUM_SLOTS; i++ )
+  {
+    Slot& slot = slots_[i];
+    slot.image.reset();
+    if( slot.width != 1 || slot.height != 1 || slot.format != Ogre::PF_BYTE_RGBA || !slot.mipmaps )
+      createTexture( slot, 1, 1, Ogre::PF_BYTE_RGBA, true );
+    upload( slot, BLANK_PIXEL, 4, Ogre::PF_BYTE_RGBA );
+    slot.bayer_red = -1;
+  }
+  front_ = 0;
+  ready_ = -1;
+}
+
+Ogre::PixelFormat ProjectorTexture::getPixelFormat( const std::string& encoding )
+{
+  namespace enc = sensor_msgs::image_encodings;
+  if( encoding == enc::RGB8 )
+    return Ogre::PF_BYTE_RGB;
+  if( encoding == enc::BGR8 || encoding == enc::TYPE_8UC3 )
+    return Ogre::PF_BYTE_BGR;
+  if( encoding == enc::RGBA8 )
+    return Ogre::PF_BYTE_RGBA;
+  if( encoding == enc::BGRA8 || encoding == enc::TYPE_8UC4 )
+    return Ogre::PF_BYTE_BGRA;
+  if( encoding == enc::MONO8 || encoding == enc::TYPE_8UC1 )
+    return Ogre::PF_BYTE_L;
+  if( encoding == enc::MONO16 || encoding == enc::TYPE_16UC1 )
+    return Ogre::PF_L16;
+  return Ogre::PF_UNKNOWN;
+}
+
+void ProjectorTexture::setDownsample( uint32_t factor )
+{
+  downsample_ = std::max<uint32_t>( factor, 1 );
+}
+
+bool ProjectorTexture::update()
+{
+  sensor_msgs::Image::ConstPtr image;
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    image = pending_image_;
+    pending_image_.reset();
+  }
+
+  Ogre::PixelFormat format = Ogre::PF_UNKNOWN;
+  int bayer_code = -1;
+  if( image )
+  {
+    format = getPixelFormat( image->encoding );
+    bayer_code = getBayerConversionCode( image->encoding );
+    if( format == Ogre::PF_UNKNOWN && bayer_code < 0 )
+      throw UnsupportedImageEncoding( image->encoding );
+  }
+
+  // the image uploaded last frame has had a whole frame to reach the GPU, project it now
+  bool changed = false;
+  if( ready_ >= 0 )
+  {
+    front_ = ready_;
+    ready_ = -1;
+    changed = true;
+  }
+
+  if( !image || image->data.empty() || image->width == 0 || image->height == 0 )
+    return changed;
+
+  if( image->data.size() < (size_t)image->step * image->height )
+  {
+    ROS_ERROR( "ProjectorTexture: image data size %d doesn't match step*height (%d*%d)",
+               (int)image->data.size(), image->step, image->height );
+    return changed;
+  }
+
+  const uint8_t* data = &image->data[0];
+  uint32_t step = image->step;
+
+  int bayer_red = -1;
+  if( format == Ogre::PF_UNKNOWN && raw_bayer_ )
+  {
+    // the projector program debayers the pattern
+    format = Ogre::PF_BYTE_L;
+    bayer_red = getBayerRed( image->encoding );
+  }
+  else if( format == Ogre::PF_UNKNOWN )
+  {
+    cv::Mat raw( image->height, image->width, CV_8UC1, (void*)data, step );
+    cv::cvtColor( raw, scratch_, bayer_code );
+    data = scratch_.data;
+    step = scratch_.step;
+    format = Ogre::PF_BYTE_BGR;
+  }
+  else if( format == Ogre::PF_L16 && image->is_bigendian )
+  {
+    scratch_.create( image->height, image->width, CV_16UC1 );
+    for( uint32_t row = 0; row < image->height; row++ )
+    {
+      const uint8_t* src = data + row * step;
+      uint8_t* dst = scratch_.ptr<uint8_t>( row );
+      for( uint32_t i = 0; i < image->width; i++ )
+      {
+        dst[2*i] = src[2*i+1];
+        dst[2*i+1] = src[2*i];
+      }
+    }
+    data = scratch_.data;
+    step = scratch_.step;
+  }
+
+  // the slot after the front one was projected two frames ago, so the GPU is done with it
+  int back = ( front_ + 1 ) % NUM_SLOTS;
+  Slot& slot = slots_[back];
+  uint32_t width = image->width;
+  uint32_t height = image->height;
+  if( bayer_red >= 0 && downsample_ > 1 && width >= 2*downsample_ && height >= 2*downsample_ )
+  {
+    // averaging would mix the colours of the pattern, every downsample_-th 2x2 block is kept instead
+    width = width / ( 2*downsample_ ) * 2;
+    height = height / ( 2*downsample_ ) * 2;
+    resized_.create( height, width, CV_8UC1 );
+    for( uint32_t row = 0; row < height; row++ )
+    {
+      const uint8_t* src = data + (size_t)( row / 2 * 2 * downsample_ + row % 2 ) * step;
+      uint8_t* dst = resized_.ptr<uint8_t>( row );
+      for( uint32_t column = 0; column < width; column += 2 )
+      {
+        dst[column] = src[column * downsample_];
+        dst[column+1] = src[column * downsample_ + 1];
+      }
+    }
+    data = resized_.data;
+    step = resized_.step;
+  }
+  else if( bayer_red < 0 && downsample_ > 1 && width >= downsample_ && height >= downsample_ )
+  {
+    // the projection only covers a small part of the screen, no point uploading every pixel
+    cv::Mat full( height, width, getCvType( format ), (void*)data, step );
+    width /= downsample_;
+    height /= downsample_;
+    cv::resize( full, resized_, cv::Size( width, height ), 0, 0, cv::INTER_AREA );
+    data = resized_.data;
+    step = resized_.step;
+  }
+
+  bool mipmaps = bayer_red < 0;
+  if( width != slot.width || height != slot.height || format != slot.format || mipmaps != slot.mipmaps )
+    createTexture( slot, width, height, format, mipmaps );
+
+  upload( slot, data, step, format );
+  slot.image = image;
+  slot.bayer_red = bayer_red;
+  ready_ = back;
+
+  return changed;
+}
+
+void ProjectorTexture::createTexture( Slot& slot, uint32_t width, uint32_t height, Ogre::PixelFormat format, bool mipmaps )
+{
+  destroyTexture( slot );
+
+  static int count = 0;
+  std::stringstream ss;
+  ss << "ProjectorTexture" << count++;
+  slot.texture = Ogre::TextureManager::getSingleton().createManual( ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                                                    Ogre::TEX_TYPE_2D, width, height, mipmaps ? Ogre::MIP_UNLIMITED : 0, format,
+                                                                    Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE | ( mipmaps ? Ogre::TU_AUTOMIPMAP : 0 ));
+  slot.width = width;
+  slot.height = height;
+  slot.format = format;
+  slot.mipmaps = mipmaps;
+}
+
+void ProjectorTexture::destroyTexture( Slot& slot )
+{
+  if( slot.texture.isNull() )
+    return;
+
+  std::string name = slot.texture->getName();
+  slot.texture.setNull();
+  Ogre::TextureManager::getSingleton().remove( name );
+}
+
+void ProjectorTexture::upload( Slot& slot, const uint8_t* data, uint32_t step, Ogre::PixelFormat format )
+{
+  size_t pixel_size = Ogre::PixelUtil::getNumElemBytes( format );
+
+  Ogre::PixelBox pixel_box( slot.width, slot.height, 1, format, (void*)data );
+  if( step != slot.width * pixel_size )
+  {
+    if( step % pixel_size != 0 )
+    {
+      // row padding that isn't a whole pixel can't be described to Ogre, pack the rows first
+      cv::Mat packed( slot.height, slot.width * pixel_size, CV_8UC1 );
+      for( uint32_t row = 0; row < slot.height; row++ )
+        memcpy( packed.ptr<uint8_t>( row ), data + row * step, slot.width * pixel_size );
+      pixel_box.data = packed.data;
+      slot.texture->getBuffer()->blitFromMemory( pixel_box );
+      return;
+    }
+    pixel_box.rowPitch = step / pixel_size;
+    pixel_box.slicePitch = pixel_box.rowPitch * slot.height;
+  }
+
+  slot.texture->getBuffer()->blitFromMemory( pixel_box );
+}
+
+} // namespace rviz
@@ -0,0 +1,146 @@
+/*
+ * ProjectorTexture declaration.
+ *
+ * Uploads camera images in their native pixel format for the mesh projector.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_PROJECTOR_TEXTURE_H
+#define RVIZ_PROJECTOR_TEXTURE_H
+
+#include <sensor_msgs/Image.h>
+
+#include <OGRE/OgreTexture.h>
+#include <OGRE/OgrePixelFormat.h>
+
+#include <opencv2/core/core.hpp>
+
+#include <boost/thread/mutex.hpp>
+
+#include <vector>
+
+namespace rviz
+{
+
+/**
+ * \class ProjectorTexture
+ * \brief Replacement for ROSImageTexture that avoids converting images to a common format.
+ *
+ * Images are uploaded with the Ogre pixel format matching their encoding (mono8, mono16, rgb8,
+ * bgr8, rgba8, bgra8), so channel order is handled by the texture format instead of a CPU swizzle.
+ * Textures are only reallocated when the image size or format changes. Bayer images are uploaded
+ * raw as luminance when the projector programs debayer them (see setRawBayer()), and debayered on
+ * the CPU for the fixed-function projector otherwise.
+ *
+ * Textures are mipmapped, and images can be downsampled by a power of two before upload when the
+ * projection covers only a small part of the screen.
+ *
+ * Images are streamed through a ring of textures: a new image is uploaded into a texture the
+ * projector is not using, and getTexture() only switches to it on the following update(), so the
+ * transfer overlaps with rendering the previous frame instead of stalling on the bound texture.
+ */
+class ProjectorTexture
+{
+public:
+  ProjectorTexture();
+  ~ProjectorTexture();
+
+  // thread safe, the newest image replaces any image not uploaded yet
+  void addMessage( const sensor_msgs::Image::ConstPtr& image );
+
+  // switches to the texture uploaded in the previous call and starts uploading the pending image;
+  // returns true if the current texture/image changed. Throws UnsupportedImageEncoding
+  bool update();
+  void clear();
+
+  // integer factor by which following images are shrunk before upload, 1 uploads full resolution
+  void setDownsample( uint32_t factor );
+  uint32_t getDownsample() const { return downsample_; }
+
+  // uploads following bayer images without debayering them, for projector programs that do it
+  void setRawBayer( bool raw ) { raw_bayer_ = raw; }
+
+  // texture and image to project this frame
+  const Ogre::TexturePtr& getTexture() { return slots_[front_].texture; }
+  const sensor_msgs::Image::ConstPtr& getImage() { return slots_[front_].image; }
+
+  uint32_t getWidth() { return slots_[front_].width; }
+  uint32_t getHeight() { return slots_[front_].height; }
+
+  // for a raw bayer texture the position x + 2*y of the red pixel in every 2x2 block, -1 otherwise
+  int getBayerRed() { return slots_[front_].bayer_red; }
+
+  // pixel format used for an encoding, PF_UNKNOWN if it can't be uploaded directly
+  static Ogre::PixelFormat getPixelFormat( const std::string& encoding );
+
+private:
+  struct Slot
+  {
+    Slot() : format( Ogre::PF_UNKNOWN ), width( 0 ), height( 0 ), mipmaps( true ), bayer_red( -1 ) {}
+
+    Ogre::TexturePtr texture;
+    Ogre::PixelFormat format;
+    uint32_t width;
+    uint32_t height;
+    // raw bayer textures have no mipmaps, they would average pixels of different colours
+    bool mipmaps;
+    int bayer_red;
+    sensor_msgs::Image::ConstPtr image;
+  };
+
+  void createTexture( Slot& slot, uint32_t width, uint32_t height, Ogre::PixelFormat format, bool mipmaps );
+  void destroyTexture( Slot& slot );
+  void upload( Slot& slot, const uint8_t* data, uint32_t step, Ogre::PixelFormat format );
+
+  // one texture being projected, one possibly still read by the GPU and one being uploaded
+  static const int NUM_SLOTS = 3;
+  Slot slots_[NUM_SLOTS];
+  int front_;
+  int ready_;
+
+  sensor_msgs::Image::ConstPtr pending_image_;
+  boost::mutex mutex_;
+
+  uint32_t downsample_;
+  bool raw_bayer_;
+
+  // scratch space for encodings that need work before upload (bayer, big endian mono16)
+  cv::Mat scratch_;
+  cv::Mat resized_;
+};
+
+} // namespace rviz
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * Mesh vertex layouts.
+ *
+ * Compile-time vertex writers for the hardware layouts of MeshDisplayCustom.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef RVIZ_VERTEX_LAYOUT_H
+#define RVIZ_VERTEX_LAYOUT_H
+
+#include <OGRE/OgreHardwareVertexBuffer.h>
+#include <OGRE/OgreVector3.h>
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+namespace rviz
+{
+
+/*
+ * Every layout describes one hardware vertex format: its size, its Ogre declaration and how to
+ * write a vertex from a position and a normal. Writers are templates over the layout, so the
+ * per-vertex loop is fully inlined with no branches on the format and no virtual calls.
+ */
+
+// x,y,z,nx,ny,nz as floats, the layout MeshBuffer::vertices is built in
+struct FloatVertexLayout
+{
+  static const size_t SIZE = 6 * sizeof(float);
+
+  struct Params {};
+
+  static void declare( Ogre::VertexDeclaration* decl )
+  {
+    decl->removeAllElements();
+    decl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
+    decl->addElement( 0, 3 * sizeof(float), Ogre::VET_FLOAT3, Ogre::VES_NORMAL );
+  }
+
+  static void write( void* dst, const float* position, const float* normal, const Params& )
+  {
+    float* v = static_cast<float*>( dst );
+    v[0] = position[0];
+    v[1] = position[1];
+    v[2] = position[2];
+    v[3] = normal[0];
+    v[4] = normal[1];
+    v[5] = normal[2];
+  }
+};
+
+// x,y,z,1 quantized to 16 bit and an octahedral normal in a 16 bit texture coordinate pair
+struct CompactVertexLayout
+{
+  static const size_t SIZE = 6 * sizeof(int16_t);
+
+  struct Params
+  {
+    Ogre::Vector3 offset;
+    Ogre::Vector3 inverse_scale;
+  };
+
+  static void declare( Ogre::VertexDeclaration* decl )
+  {
+    // the octahedral normal travels as a texture coordinate, the vertex program decodes it
+    decl->removeAllElements();
+    decl->addElement( 0, 0, Ogre::VET_SHORT4, Ogre::VES_POSITION );
+    decl->addElement( 0, 4 * sizeof(int16_t), Ogre::VET_SHORT2, Ogre::VES_TEXTURE_COORDINATES, 0 );
+  }
+
+  static int16_t quantize( float value )
+  {
+    return (int16_t)floorf( std::min( std::max( value, -32767.0f ), 32767.0f ) + 0.5f );
+  }
+
+  static void write( void* dst, const float* position, const float* normal, const Params& params )
+  {
+    int16_t* v = static_cast<int16_t*>( dst );
+    v[0] = quantize(( position[0] - params.offset.x ) * params.inverse_scale.x );
+    v[1] = quantize(( position[1] - params.offset.y ) * params.inverse_scale.y );
+    v[2] = quantize(( position[2] - params.offset.z ) * params.inverse_scale.z );
+    v[3] = 1;
+
+    // octahedral mapping: project onto |x|+|y|+|z| = 1 and fold the lower half over the diagonals
+    float length = fabsf( normal[0] ) + fabsf( normal[1] ) + fabsf( normal[2] );
+    float scale = length > 0.0f ? 1.0f / length : 0.0f;
+    float x = normal[0] * scale;
+    float y = normal[1] * scale;
+    if( normal[2] < 0.0f )
+    {
+      float folded_x = ( 1.0f - fabsf( y )) * ( x >= 0.0f ? 1.0f : -1.0f );
+      float folded_y = ( 1.0f - fabsf( x )) * ( y >= 0.0f ? 1.0f : -1.0f );
+      x = folded_x;
+      y = folded_y;
+    }
+    v[4] = quantize( x * 32767.0f );
+    v[5] = quantize( y * 32767.0f );
+  }
+};
+
+// converts count interleaved position/normal float vertices into Layout at dst
+template<class Layout>
+void writeVertices( const float* src, size_t count, const typename Layout::Params& params, void* dst )
+{
+  unsigned char* out = static_cast<unsigned char*>( dst );
+  for( size_t i = 0; i < count; i++, src += 6, out += Layout::SIZE )
+    Layout::write( out, src, src + 3, params );
+}
+
+// plain copy when the source already is in the float layout
+template<>
+inline void writeVertices<FloatVertexLayout>( const float* src, size_t count, const FloatVertexLayout::Params&, void* dst )
+{
+  memcpy( dst, src, count * FloatVertexLayout::SIZE );
+}
+
+} // namespace rviz
+
+#endif
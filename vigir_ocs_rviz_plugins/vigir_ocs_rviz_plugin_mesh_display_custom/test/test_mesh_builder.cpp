@@ -0,0 +1,366 @@
+/*
+ * Tests of the mesh buffer builder.
+ *
+ * Builds flat grids, whose normals and chunks are known in advance.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+#include "mesh_builder.h"
+#include "vertex_layout.h"
+
+using namespace rviz;
+
+namespace
+{
+
+// size x size quads in the z = 0 plane, two counter clockwise triangles each
+void makeGrid( uint32_t size, shape_msgs::Mesh& mesh )
+{
+  mesh.vertices.clear();
+  mesh.triangles.clear();
+  for( uint32_t y = 0; y <= size; y++ )
+  {
+    for( uint32_t x = 0; x <= size; x++ )
+    {
+      geometry_msgs::Point point;
+      point.x = x;
+      point.y = y;
+      point.z = 0.0;
+      mesh.vertices.push_back( point );
+    }
+  }
+  for( uint32_t y = 0; y < size; y++ )
+  {
+    for( uint32_t x = 0; x < size; x++ )
+    {
+      uint32_t v = y * ( size + 1 ) + x;
+      shape_msgs::MeshTriangle triangle;
+      triangle.vertex_indices[0] = v;
+      triangle.vertex_indices[1] = v + 1;
+      triangle.vertex_indices[2] = v + size + 2;
+      mesh.triangles.push_back( triangle );
+      triangle.vertex_indices[1] = v + size + 2;
+      triangle.vertex_indices[2] = v + size + 1;
+      mesh.triangles.push_back( triangle );
+    }
+  }
+}
+
+// what the builder thread fills in before it compares buffers
+void build( const shape_msgs::Mesh& mesh, MeshBuffer& buffer )
+{
+  MeshBuilder::buildIndexed( mesh, buffer );
+  buffer.triangle_count = mesh.triangles.size();
+}
+
+// the inverse of the octahedral mapping, as done by the compact vertex program
+Ogre::Vector3 decodeOctahedral( int16_t encoded_x, int16_t encoded_y )
+{
+  float x = encoded_x / 32767.0f;
+  float y = encoded_y / 32767.0f;
+  Ogre::Vector3 normal( x, y, 1.0f - fabsf( x ) - fabsf( y ));
+  if( normal.z < 0.0f )
+  {
+    normal.x = ( 1.0f - fabsf( y )) * ( x >= 0.0f ? 1.0f : -1.0f );
+    normal.y = ( 1.0f - fabsf( x )) * ( y >= 0.0f ? 1.0f : -1.0f );
+  }
+  normal.normalise();
+  return normal;
+}
+
+bool lessIndexStart( const MeshChunk& a, const MeshChunk& b )
+{
+  return a.index_start < b.index_start;
+}
+
+} // namespace
+
+TEST( MeshBuilder, FindsMovedVertices )
+{
+  shape_msgs::Mesh mesh;
+  makeGrid( 64, mesh );
+  MeshBuffer base;
+  build( mesh, base );
+
+  // moved inside the plane, so the normals around them stay the same
+  for( size_t i = 100; i < 110; i++ )
+    mesh.vertices[i].x += 0.25;
+  mesh.vertices[300].y += 0.25;
+  mesh.vertices[340].y += 0.25;
+  mesh.vertices[2000].x -= 0.25;
+  MeshBuffer buffer;
+  build( mesh, buffer );
+
+  ASSERT_TRUE( MeshBuilder::findDirtyRanges( base, buffer ));
+  EXPECT_TRUE( buffer.vertices_only );
+  std::vector<std::pair<size_t, size_t> > expected;
+  expected.push_back( std::make_pair( 100, 10 ));
+  // close ranges are merged into one write
+  expected.push_back( std::make_pair( 300, 41 ));
+  expected.push_back( std::make_pair( 2000, 1 ));
+  EXPECT_EQ( expected, buffer.dirty_ranges );
+}
+
+TEST( MeshBuilder, UnchangedMeshHasNoDirtyRanges )
+{
+  shape_msgs::Mesh mesh;
+  makeGrid( 8, mesh );
+  MeshBuffer base, buffer;
+  build( mesh, base );
+  build( mesh, buffer );
+
+  ASSERT_TRUE( MeshBuilder::findDirtyRanges( base, buffer ));
+  EXPECT_TRUE( buffer.dirty_ranges.empty() );
+}
+
+TEST( MeshBuilder, RejectsTopologyChange )
+{
+  shape_msgs::Mesh mesh;
+  makeGrid( 8, mesh );
+  MeshBuffer base;
+  build( mesh, base );
+
+  mesh.triangles.pop_back();
+  MeshBuffer buffer;
+  build( mesh, buffer );
+  buffer.vertices_only = true;
+
+  EXPECT_FALSE( MeshBuilder::findDirtyRanges( base, buffer ));
+  EXPECT_FALSE( buffer.vertices_only );
+  EXPECT_TRUE( buffer.dirty_ranges.empty() );
+}
+
+TEST( MeshBuilder, ChunksCoverEveryTriangleOnce )
+{
+  shape_msgs::Mesh mesh;
+  makeGrid( 256, mesh );
+  MeshBuffer buffer;
+  build( mesh, buffer );
+  std::vector<boost::array<uint32_t, 3> > triangles;
+  for( size_t i = 0; i < buffer.indices.size(); i += 3 )
+  {
+    boost::array<uint32_t, 3> triangle = {{ buffer.indices[i], buffer.indices[i+1], buffer.indices[i+2] }};
+    triangles.push_back( triangle );
+  }
+
+  MeshBuilder::buildChunks( buffer );
+  ASSERT_GT( buffer.chunks.size(), 1u );
+
+  // the chunks tile the index buffer without gaps or overlaps
+  std::vector<MeshChunk> chunks = buffer.chunks;
+  std::sort( chunks.begin(), chunks.end(), lessIndexStart );
+  size_t next = 0;
+  for( size_t c = 0; c < chunks.size(); c++ )
+  {
+    EXPECT_EQ( next, chunks[c].index_start );
+    EXPECT_GT( chunks[c].index_count, 0u );
+    EXPECT_EQ( 0u, chunks[c].index_count % 3 );
+    next = chunks[c].index_start + chunks[c].index_count;
+
+    for( size_t i = chunks[c].index_start; i < next; i++ )
+    {
+      const float* v = &buffer.vertices[buffer.indices[i] * MeshBuffer::FLOATS_PER_VERTEX];
+      ASSERT_TRUE( chunks[c].bounds.contains( Ogre::Vector3( v[0], v[1], v[2] ))) << "chunk " << c;
+    }
+  }
+  EXPECT_EQ( buffer.indices.size(), next );
+
+  // and hold the same triangles, reordered but with their winding intact
+  std::vector<boost::array<uint32_t, 3> > chunked;
+  for( size_t i = 0; i < buffer.indices.size(); i += 3 )
+  {
+    boost::array<uint32_t, 3> triangle = {{ buffer.indices[i], buffer.indices[i+1], buffer.indices[i+2] }};
+    chunked.push_back( triangle );
+  }
+  std::sort( triangles.begin(), triangles.end() );
+  std::sort( chunked.begin(), chunked.end() );
+  EXPECT_TRUE( triangles == chunked );
+}
+
+TEST( MeshBuilder, SmallMeshHasNoChunks )
+{
+  shape_msgs::Mesh mesh;
+  makeGrid( 16, mesh );
+  MeshBuffer buffer;
+  build( mesh, buffer );
+  std::vector<uint32_t> indices = buffer.indices;
+
+  MeshBuilder::buildChunks( buffer );
+  EXPECT_TRUE( buffer.chunks.empty() );
+  EXPECT_EQ( indices, buffer.indices );
+}
+
+TEST( MeshBuilder, ParallelNormalsMatchSerialAccumulation )
+{
+  // large enough to be split over several ranges, with a wave and random winding so the sign
+  // alignment is exercised
+  shape_msgs::Mesh mesh;
+  makeGrid( 300, mesh );
+  for( size_t i = 0; i < mesh.vertices.size(); i++ )
+    mesh.vertices[i].z = 0.3 * sin( mesh.vertices[i].x * 0.1 ) * cos( mesh.vertices[i].y * 0.13 );
+  srand( 1 );
+  for( size_t t = 0; t < mesh.triangles.size(); t++ )
+    if( rand() % 2 )
+      std::swap( mesh.triangles[t].vertex_indices[1], mesh.triangles[t].vertex_indices[2] );
+
+  MeshBuffer buffer;
+  build( mesh, buffer );
+
+  // every vertex sums its faces in triangle order, whatever ranges the builder split it into
+  std::vector<Ogre::Vector3> sums( mesh.vertices.size(), Ogre::Vector3::ZERO );
+  for( size_t t = 0; t < mesh.triangles.size(); t++ )
+  {
+    Ogre::Vector3 corners[3];
+    for( int c = 0; c < 3; c++ )
+    {
+      const float* v = &buffer.vertices[mesh.triangles[t].vertex_indices[c] * MeshBuffer::FLOATS_PER_VERTEX];
+      corners[c] = Ogre::Vector3( v[0], v[1], v[2] );
+    }
+    Ogre::Vector3 normal = ( corners[1] - corners[0] ).crossProduct( corners[2] - corners[0] );
+    for( int c = 0; c < 3; c++ )
+    {
+      Ogre::Vector3& sum = sums[mesh.triangles[t].vertex_indices[c]];
+      sum += sum.dotProduct( normal ) < 0.0f ? -normal : normal;
+    }
+  }
+
+  for( size_t i = 0; i < sums.size(); i++ )
+  {
+    sums[i].normalise();
+    const float* n = &buffer.vertices[i * MeshBuffer::FLOATS_PER_VERTEX + 3];
+    ASSERT_EQ( sums[i].x, n[0] ) << "vertex " << i;
+    ASSERT_EQ( sums[i].y, n[1] ) << "vertex " << i;
+    ASSERT_EQ( sums[i].z, n[2] ) << "vertex " << i;
+  }
+}
+
+TEST( CompactVertexLayout, QuantizesPositionsToHalfAStep )
+{
+  const Ogre::Vector3 offset( 10.0f, -5.0f, 2.0f );
+  const Ogre::Vector3 half_size( 20.0f, 4.0f, 0.5f );
+  CompactVertexLayout::Params params;
+  params.offset = offset;
+  Ogre::Vector3 scale;
+  for( int a = 0; a < 3; a++ )
+  {
+    scale[a] = half_size[a] / 32767.0f;
+    params.inverse_scale[a] = 1.0f / scale[a];
+  }
+
+  const float normal[3] = { 0.0f, 0.0f, 1.0f };
+  for( int i = 0; i <= 1000; i++ )
+  {
+    // walks the box diagonally, corners included
+    float t = i / 500.0f - 1.0f;
+    float position[3] = { offset.x + t * half_size.x, offset.y - t * half_size.y, offset.z + t * t * t * half_size.z };
+    int16_t v[6];
+    CompactVertexLayout::write( v, position, normal, params );
+
+    EXPECT_EQ( 1, v[3] );
+    for( int a = 0; a < 3; a++ )
+      EXPECT_NEAR( position[a], offset[a] + v[a] * scale[a], scale[a] * 0.5f + 1e-5f * half_size[a] ) << "axis " << a << " at " << t;
+  }
+}
+
+TEST( CompactVertexLayout, ClampsPositionsOutsideTheBounds )
+{
+  CompactVertexLayout::Params params;
+  params.offset = Ogre::Vector3::ZERO;
+  params.inverse_scale = Ogre::Vector3( 32767.0f, 32767.0f, 32767.0f );
+
+  const float position[3] = { 2.0f, -2.0f, 0.0f };
+  const float normal[3] = { 0.0f, 0.0f, 1.0f };
+  int16_t v[6];
+  CompactVertexLayout::write( v, position, normal, params );
+  EXPECT_EQ( 32767, v[0] );
+  EXPECT_EQ( -32767, v[1] );
+  EXPECT_EQ( 0, v[2] );
+}
+
+TEST( CompactVertexLayout, EncodesOctahedralNormals )
+{
+  CompactVertexLayout::Params params;
+  params.offset = Ogre::Vector3::ZERO;
+  params.inverse_scale = Ogre::Vector3::UNIT_SCALE;
+  const float position[3] = { 0.0f, 0.0f, 0.0f };
+
+  // a spiral over the whole sphere plus the axes, where the fold meets the diagonals
+  std::vector<Ogre::Vector3> normals;
+  for( int i = 0; i < 2000; i++ )
+  {
+    float z = 1.0f - ( i + 0.5f ) / 1000.0f;
+    float r = sqrtf( std::max( 0.0f, 1.0f - z * z ));
+    normals.push_back( Ogre::Vector3( r * cosf( i * 2.4f ), r * sinf( i * 2.4f ), z ));
+  }
+  for( int a = 0; a < 3; a++ )
+  {
+    Ogre::Vector3 axis( Ogre::Vector3::ZERO );
+    axis[a] = 1.0f;
+    normals.push_back( axis );
+    normals.push_back( -axis );
+  }
+
+  float max_error = 0.0f;
+  for( size_t i = 0; i < normals.size(); i++ )
+  {
+    int16_t v[6];
+    CompactVertexLayout::write( v, position, &normals[i].x, params );
+    Ogre::Vector3 decoded = decodeOctahedral( v[4], v[5] );
+    max_error = std::max( max_error, ( decoded - normals[i] ).length() );
+  }
+  // 16 bit octahedral normals are good to about a hundredth of a degree
+  EXPECT_LT( max_error, 1e-4f );
+}
+
+TEST( CompactVertexLayout, KeepsZeroNormals )
+{
+  CompactVertexLayout::Params params;
+  params.offset = Ogre::Vector3::ZERO;
+  params.inverse_scale = Ogre::Vector3::UNIT_SCALE;
+  const float position[3] = { 0.0f, 0.0f, 0.0f };
+  const float normal[3] = { 0.0f, 0.0f, 0.0f };
+  int16_t v[6];
+  CompactVertexLayout::write( v, position, normal, params );
+  EXPECT_EQ( 0, v[4] );
+  EXPECT_EQ( 0, v[5] );
+}
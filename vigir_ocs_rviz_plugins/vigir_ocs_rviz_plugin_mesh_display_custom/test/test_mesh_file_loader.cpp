@@ -0,0 +1,315 @@
+/*
+ * Tests of the PLY and STL readers.
+ *
+ * Files are assembled in memory byte by byte, so every case states exactly what is on disk.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <string>
+
+#include "mesh_file_loader.h"
+
+using namespace rviz;
+
+namespace
+{
+
+// appends value in little or big endian byte order
+template<typename T>
+void append( std::string& data, T value, bool big_endian = false )
+{
+  unsigned char bytes[sizeof(T)];
+  memcpy( bytes, &value, sizeof(T) );
+  uint16_t probe = 1;
+  bool host_little = *(unsigned char*)&probe == 1;
+  for( size_t i = 0; i < sizeof(T); i++ )
+    data.push_back( bytes[host_little == !big_endian ? i : sizeof(T) - 1 - i] );
+}
+
+// the unit square at z = 2 as four vertices with an extra color byte and one quad
+std::string makeSquarePly( bool big_endian )
+{
+  std::string data = std::string( "ply\nformat " ) + ( big_endian ? "binary_big_endian" : "binary_little_endian" ) + " 1.0\n"
+                     "element vertex 4\nproperty float x\nproperty float y\nproperty float z\nproperty uchar red\n"
+                     "element face 1\nproperty list uchar int vertex_indices\nend_header\n";
+  float corners[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+  for( int v = 0; v < 4; v++ )
+  {
+    append<float>( data, corners[v][0], big_endian );
+    append<float>( data, corners[v][1], big_endian );
+    append<float>( data, 2.0f, big_endian );
+    append<uint8_t>( data, 255 );
+  }
+  append<uint8_t>( data, 4 );
+  for( int32_t v = 0; v < 4; v++ )
+    append<int32_t>( data, v, big_endian );
+  return data;
+}
+
+bool readPly( const std::string& data, shape_msgs::Mesh& mesh, std::string& error )
+{
+  return MeshFileLoader::readPly( (const unsigned char*)data.data(), data.size(), mesh, error );
+}
+
+bool readStl( const std::string& data, shape_msgs::Mesh& mesh, std::string& error )
+{
+  return MeshFileLoader::readStl( (const unsigned char*)data.data(), data.size(), mesh, error );
+}
+
+void appendStlTriangle( std::string& data, const float corners[3][3] )
+{
+  for( int a = 0; a < 3; a++ )
+    append<float>( data, 0.0f );
+  for( int c = 0; c < 3; c++ )
+    for( int a = 0; a < 3; a++ )
+      append<float>( data, corners[c][a] );
+  append<uint16_t>( data, 0 );
+}
+
+} // namespace
+
+TEST( MeshFileLoader, ReadsLittleEndianPly )
+{
+  shape_msgs::Mesh mesh;
+  std::string error;
+  ASSERT_TRUE( readPly( makeSquarePly( false ), mesh, error )) << error;
+  ASSERT_EQ( 4u, mesh.vertices.size() );
+  ASSERT_EQ( 2u, mesh.triangles.size() );
+  EXPECT_FLOAT_EQ( 1.0f, mesh.vertices[2].x );
+  EXPECT_FLOAT_EQ( 1.0f, mesh.vertices[2].y );
+  EXPECT_FLOAT_EQ( 2.0f, mesh.vertices[2].z );
+
+  // the quad is split into a fan around its first corner
+  EXPECT_EQ( 0u, mesh.triangles[1].vertex_indices[0] );
+  EXPECT_EQ( 2u, mesh.triangles[1].vertex_indices[1] );
+  EXPECT_EQ( 3u, mesh.triangles[1].vertex_indices[2] );
+}
+
+TEST( MeshFileLoader, ReadsBigEndianPly )
+{
+  shape_msgs::Mesh little, big;
+  std::string error;
+  ASSERT_TRUE( readPly( makeSquarePly( false ), little, error )) << error;
+  ASSERT_TRUE( readPly( makeSquarePly( true ), big, error )) << error;
+  ASSERT_EQ( little.vertices.size(), big.vertices.size() );
+  for( size_t v = 0; v < little.vertices.size(); v++ )
+  {
+    EXPECT_EQ( little.vertices[v].x, big.vertices[v].x );
+    EXPECT_EQ( little.vertices[v].y, big.vertices[v].y );
+    EXPECT_EQ( little.vertices[v].z, big.vertices[v].z );
+  }
+  ASSERT_EQ( little.triangles.size(), big.triangles.size() );
+  for( size_t t = 0; t < little.triangles.size(); t++ )
+    for( int c = 0; c < 3; c++ )
+      EXPECT_EQ( little.triangles[t].vertex_indices[c], big.triangles[t].vertex_indices[c] );
+}
+
+TEST( MeshFileLoader, ReadsPlyListTypes )
+{
+  // double positions, a ushort list length and uint indices, after an element the reader skips
+  std::string data = "ply\nformat binary_little_endian 1.0\ncomment other types\n"
+                     "element material 1\nproperty list uchar float values\n"
+                     "element vertex 3\nproperty double x\nproperty double y\nproperty double z\n"
+                     "element face 1\nproperty list ushort uint vertex_index\nend_header\n";
+  append<uint8_t>( data, 2 );
+  append<float>( data, 0.5f );
+  append<float>( data, 0.25f );
+  for( int v = 0; v < 3; v++ )
+  {
+    append<double>( data, v );
+    append<double>( data, v * 2 );
+    append<double>( data, v * 3 );
+  }
+  append<uint16_t>( data, 3 );
+  for( uint32_t v = 0; v < 3; v++ )
+    append<uint32_t>( data, 2 - v );
+
+  shape_msgs::Mesh mesh;
+  std::string error;
+  ASSERT_TRUE( readPly( data, mesh, error )) << error;
+  ASSERT_EQ( 3u, mesh.vertices.size() );
+  ASSERT_EQ( 1u, mesh.triangles.size() );
+  EXPECT_DOUBLE_EQ( 4.0, mesh.vertices[2].y );
+  EXPECT_DOUBLE_EQ( 6.0, mesh.vertices[2].z );
+  EXPECT_EQ( 2u, mesh.triangles[0].vertex_indices[0] );
+  EXPECT_EQ( 0u, mesh.triangles[0].vertex_indices[2] );
+}
+
+TEST( MeshFileLoader, RejectsTruncatedPly )
+{
+  std::string data = makeSquarePly( false );
+  shape_msgs::Mesh mesh;
+  std::string error;
+  for( size_t cut = 1; cut <= 17; cut++ )
+  {
+    EXPECT_FALSE( readPly( data.substr( 0, data.size() - cut ), mesh, error )) << "cut " << cut;
+    EXPECT_NE( std::string::npos, error.find( "truncated" )) << error;
+  }
+}
+
+TEST( MeshFileLoader, RejectsBadPlyHeaders )
+{
+  const char* headers[] =
+  {
+    // no end of the header
+    "ply\nformat binary_little_endian 1.0\nelement vertex 3\n",
+    "ply\nformat ascii 1.0\nelement vertex 0\nend_header\n",
+    "ply\nformat binary_little_endian 1.0\nelement vertex -1\nproperty float x\nend_header\n",
+    "ply\nformat binary_little_endian 1.0\nelement vertex 3x\nproperty float x\nend_header\n",
+    "ply\nformat binary_little_endian 1.0\nelement vertex 99999999999999999999999\nproperty float x\nend_header\n",
+    "ply\nformat binary_little_endian 1.0\nelement vertex\nend_header\n",
+    "ply\nformat binary_little_endian 1.0\nelement vertex 3\nproperty half x\nend_header\n",
+    // rows without properties take no bytes, so the count can't be checked against the size
+    "ply\nformat binary_little_endian 1.0\nelement vertex 1000000000000\nend_header\n",
+  };
+  for( size_t i = 0; i < sizeof(headers) / sizeof(headers[0]); i++ )
+  {
+    shape_msgs::Mesh mesh;
+    std::string error;
+    EXPECT_FALSE( readPly( headers[i], mesh, error )) << headers[i];
+    EXPECT_FALSE( error.empty() ) << headers[i];
+  }
+}
+
+TEST( MeshFileLoader, RejectsNegativePlyListLength )
+{
+  std::string data = "ply\nformat binary_little_endian 1.0\n"
+                     "element vertex 1\nproperty float x\nproperty float y\nproperty float z\n"
+                     "element face 1\nproperty list char int vertex_indices\nend_header\n";
+  for( int a = 0; a < 3; a++ )
+    append<float>( data, 0.0f );
+  append<int8_t>( data, -3 );
+  for( int i = 0; i < 8; i++ )
+    append<int32_t>( data, 0 );
+
+  shape_msgs::Mesh mesh;
+  std::string error;
+  EXPECT_FALSE( readPly( data, mesh, error ));
+}
+
+TEST( MeshFileLoader, WeldsStlVertices )
+{
+  // the unit square as two triangles sharing a diagonal; -0 and +0 weld into one vertex
+  std::string data( 80, '\0' );
+  append<uint32_t>( data, 2 );
+  float first[3][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 } };
+  float second[3][3] = { { -0.0f, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+  appendStlTriangle( data, first );
+  appendStlTriangle( data, second );
+
+  shape_msgs::Mesh mesh;
+  std::string error;
+  ASSERT_TRUE( readStl( data, mesh, error )) << error;
+  EXPECT_EQ( 4u, mesh.vertices.size() );
+  ASSERT_EQ( 2u, mesh.triangles.size() );
+  EXPECT_EQ( mesh.triangles[0].vertex_indices[0], mesh.triangles[1].vertex_indices[0] );
+  EXPECT_EQ( mesh.triangles[0].vertex_indices[2], mesh.triangles[1].vertex_indices[1] );
+}
+
+TEST( MeshFileLoader, RejectsBadStl )
+{
+  shape_msgs::Mesh mesh;
+  std::string error;
+  EXPECT_FALSE( readStl( "solid cube\nfacet normal 0 0 1\n", mesh, error ));
+  EXPECT_EQ( "ASCII STL files are not supported", error );
+
+  // the triangle count has to match the size
+  std::string data( 80, '\0' );
+  append<uint32_t>( data, 2 );
+  float corners[3][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 } };
+  appendStlTriangle( data, corners );
+  EXPECT_FALSE( readStl( data, mesh, error ));
+  EXPECT_EQ( "not a binary STL file", error );
+
+  EXPECT_FALSE( readStl( std::string( 40, '\0' ), mesh, error ));
+}
+
+TEST( MeshFileLoader, KeysCacheByContent )
+{
+  std::string a = makeSquarePly( false ), b = makeSquarePly( true );
+  std::string path = MeshFileLoader::getCachePath( (const unsigned char*)a.data(), a.size(), "/cache" );
+  EXPECT_EQ( 0u, path.find( "/cache/" ));
+  EXPECT_EQ( path, MeshFileLoader::getCachePath( (const unsigned char*)a.data(), a.size(), "/cache" ));
+  EXPECT_NE( path, MeshFileLoader::getCachePath( (const unsigned char*)b.data(), b.size(), "/cache" ));
+  EXPECT_TRUE( MeshFileLoader::getCachePath( (const unsigned char*)a.data(), a.size(), "" ).empty() );
+}
+
+TEST( MeshFileLoader, PrunesLeastRecentlyUsedCacheFiles )
+{
+  char directory[] = "/tmp/mesh_cache_testXXXXXX";
+  ASSERT_TRUE( mkdtemp( directory ) != NULL );
+  std::string cache = directory;
+
+  // four 1000 byte files used one after the other, and a file that isn't part of the cache
+  const char* names[] = { "0.mesh", "1.mesh", "2.mesh", "3.mesh", "other" };
+  for( int i = 0; i < 5; i++ )
+  {
+    std::string path = cache + "/" + names[i];
+    FILE* file = fopen( path.c_str(), "wb" );
+    ASSERT_TRUE( file != NULL );
+    fwrite( std::string( 1000, 'x' ).data(), 1000, 1, file );
+    fclose( file );
+    struct timeval times[2];
+    times[0].tv_sec = times[1].tv_sec = 1000000 + i * 10;
+    times[0].tv_usec = times[1].tv_usec = 0;
+    utimes( path.c_str(), times );
+  }
+
+  MeshFileLoader::pruneCache( cache, 2500 );
+  struct stat info;
+  EXPECT_NE( 0, stat(( cache + "/0.mesh" ).c_str(), &info ));
+  EXPECT_NE( 0, stat(( cache + "/1.mesh" ).c_str(), &info ));
+  EXPECT_EQ( 0, stat(( cache + "/2.mesh" ).c_str(), &info ));
+  EXPECT_EQ( 0, stat(( cache + "/3.mesh" ).c_str(), &info ));
+  EXPECT_EQ( 0, stat(( cache + "/other" ).c_str(), &info ));
+
+  for( int i = 0; i < 5; i++ )
+    unlink(( cache + "/" + names[i] ).c_str() );
+  rmdir( cache.c_str() );
+}
+
+int main( int argc, char** argv )
+{
+  testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
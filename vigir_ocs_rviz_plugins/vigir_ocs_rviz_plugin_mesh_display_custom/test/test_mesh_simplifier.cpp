@@ -0,0 +1,209 @@
+/*
+ * Tests of the quadric error mesh simplifier.
+ *
+ * Runs on flat grids, where every collapse has a known effect.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "mesh_simplifier.h"
+
+using namespace rviz;
+
+namespace
+{
+
+// size x size quads in the z = 0 plane, two counter clockwise triangles each
+void makeGrid( uint32_t size, std::vector<float>& positions, std::vector<uint32_t>& indices )
+{
+  positions.clear();
+  indices.clear();
+  for( uint32_t y = 0; y <= size; y++ )
+  {
+    for( uint32_t x = 0; x <= size; x++ )
+    {
+      positions.push_back( x );
+      positions.push_back( y );
+      positions.push_back( 0.0f );
+    }
+  }
+  for( uint32_t y = 0; y < size; y++ )
+  {
+    for( uint32_t x = 0; x < size; x++ )
+    {
+      uint32_t v = y * ( size + 1 ) + x;
+      uint32_t quad[6] = { v, v + 1, v + size + 2, v, v + size + 2, v + size + 1 };
+      indices.insert( indices.end(), quad, quad + 6 );
+    }
+  }
+}
+
+float normalZ( const std::vector<float>& positions, const uint32_t* tri )
+{
+  const float* a = &positions[tri[0]*3];
+  const float* b = &positions[tri[1]*3];
+  const float* c = &positions[tri[2]*3];
+  return ( b[0] - a[0] ) * ( c[1] - a[1] ) - ( b[1] - a[1] ) * ( c[0] - a[0] );
+}
+
+} // namespace
+
+TEST( MeshSimplifier, ReachesTarget )
+{
+  std::vector<float> positions;
+  std::vector<uint32_t> indices;
+  makeGrid( 32, positions, indices );
+
+  std::vector<uint32_t> result;
+  simplifyMesh( &positions[0], 3, positions.size() / 3, indices, 256, result );
+
+  ASSERT_EQ( 0u, result.size() % 3 );
+  EXPECT_LE( result.size() / 3, 256u );
+  EXPECT_GT( result.size(), 0u );
+  for( size_t i = 0; i < result.size(); i++ )
+    ASSERT_LT( result[i], positions.size() / 3 );
+}
+
+TEST( MeshSimplifier, KeepsMeshBelowTarget )
+{
+  std::vector<float> positions;
+  std::vector<uint32_t> indices;
+  makeGrid( 4, positions, indices );
+
+  std::vector<uint32_t> result;
+  simplifyMesh( &positions[0], 3, positions.size() / 3, indices, indices.size() / 3, result );
+  EXPECT_EQ( indices, result );
+}
+
+TEST( MeshSimplifier, NeverFlipsTriangles )
+{
+  std::vector<float> positions;
+  std::vector<uint32_t> indices;
+  makeGrid( 24, positions, indices );
+
+  // a bump in the middle gives the collapses different costs
+  for( size_t i = 0; i < positions.size(); i += 3 )
+    positions[i+2] = std::max( 0.0f, 6.0f - std::abs( positions[i] - 12.0f ) - std::abs( positions[i+1] - 12.0f ));
+
+  std::vector<uint32_t> result;
+  simplifyMesh( &positions[0], 3, positions.size() / 3, indices, 64, result );
+  ASSERT_FALSE( result.empty() );
+  for( size_t t = 0; t < result.size(); t += 3 )
+    EXPECT_GT( normalZ( positions, &result[t] ), 0.0f ) << "triangle " << t / 3;
+}
+
+TEST( MeshSimplifier, KeepsOpenBorders )
+{
+  std::vector<float> positions;
+  std::vector<uint32_t> indices;
+  makeGrid( 16, positions, indices );
+
+  std::vector<uint32_t> result;
+  simplifyMesh( &positions[0], 3, positions.size() / 3, indices, 32, result );
+
+  // the simplified square still spans the whole grid and covers the same area
+  float area = 0.0f;
+  float min_x = 16.0f, max_x = 0.0f, min_y = 16.0f, max_y = 0.0f;
+  for( size_t t = 0; t < result.size(); t += 3 )
+  {
+    area += normalZ( positions, &result[t] ) * 0.5f;
+    for( int c = 0; c < 3; c++ )
+    {
+      const float* p = &positions[result[t+c]*3];
+      min_x = std::min( min_x, p[0] );
+      max_x = std::max( max_x, p[0] );
+      min_y = std::min( min_y, p[1] );
+      max_y = std::max( max_y, p[1] );
+    }
+  }
+  EXPECT_FLOAT_EQ( 0.0f, min_x );
+  EXPECT_FLOAT_EQ( 16.0f, max_x );
+  EXPECT_FLOAT_EQ( 0.0f, min_y );
+  EXPECT_FLOAT_EQ( 16.0f, max_y );
+  EXPECT_NEAR( 256.0f, area, 1e-3f );
+}
+
+TEST( MeshSimplifier, KeepsLockedVertices )
+{
+  std::vector<float> positions;
+  std::vector<uint32_t> indices;
+  makeGrid( 16, positions, indices );
+
+  // a seam down the middle, as between two chunks simplified separately
+  std::vector<bool> locked( positions.size() / 3, false );
+  for( uint32_t y = 0; y <= 16; y++ )
+    locked[y * 17 + 8] = true;
+
+  std::vector<uint32_t> result;
+  simplifyMesh( &positions[0], 3, positions.size() / 3, indices, 64, locked, result );
+  ASSERT_FALSE( result.empty() );
+  EXPECT_LE( result.size() / 3, 64u );
+
+  // every edge along the seam is still there, so both sides keep meeting
+  for( uint32_t y = 0; y < 16; y++ )
+  {
+    uint32_t a = y * 17 + 8, b = a + 17;
+    bool found = false;
+    for( size_t t = 0; t < result.size() && !found; t += 3 )
+    {
+      const uint32_t* tri = &result[t];
+      found = ( tri[0] == a || tri[1] == a || tri[2] == a ) && ( tri[0] == b || tri[1] == b || tri[2] == b );
+    }
+    EXPECT_TRUE( found ) << "seam edge " << y;
+  }
+
+  float area = 0.0f;
+  for( size_t t = 0; t < result.size(); t += 3 )
+    area += normalZ( positions, &result[t] ) * 0.5f;
+  EXPECT_NEAR( 256.0f, area, 1e-3f );
+}
+
+TEST( MeshSimplifier, EmptyMesh )
+{
+  std::vector<uint32_t> indices;
+  std::vector<uint32_t> result( 3, 0 );
+  simplifyMesh( NULL, 3, 0, indices, 0, result );
+  EXPECT_TRUE( result.empty() );
+}
+
+int main( int argc, char** argv )
+{
+  testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
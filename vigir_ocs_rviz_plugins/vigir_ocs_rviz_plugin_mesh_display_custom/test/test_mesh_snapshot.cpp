@@ -0,0 +1,273 @@
+/*
+ * Tests of the mesh snapshot format.
+ *
+ * Round trips a small chunked buffer and checks that damaged files are rejected instead of restored.
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Team ViGIR ( TORC Robotics LLC, TU Darmstadt, Virginia Tech, Oregon State University, Cornell University, and Leibniz University Hanover )
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Team ViGIR, TORC Robotics, nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "mesh_snapshot.h"
+
+using namespace rviz;
+
+namespace
+{
+
+class MeshSnapshotTest : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    char directory[] = "/tmp/mesh_snapshot_testXXXXXX";
+    ASSERT_TRUE( mkdtemp( directory ) != NULL );
+    directory_ = directory;
+    path_ = directory_ + "/test.snapshot";
+  }
+
+  virtual void TearDown()
+  {
+    unlink( path_.c_str() );
+    rmdir( directory_.c_str() );
+  }
+
+  // the unit square as two chunks of one triangle each, with one level of detail
+  static MeshBufferPtr makeBuffer()
+  {
+    MeshBufferPtr buffer( new MeshBuffer() );
+    float positions[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+    for( int v = 0; v < 4; v++ )
+    {
+      float vertex[MeshBuffer::FLOATS_PER_VERTEX] = { positions[v][0], positions[v][1], 0, 0, 0, 1 };
+      buffer->vertices.insert( buffer->vertices.end(), vertex, vertex + MeshBuffer::FLOATS_PER_VERTEX );
+    }
+    buffer->vertex_count = 4;
+    uint32_t indices[6] = { 0, 1, 2, 0, 2, 3 };
+    buffer->indices.assign( indices, indices + 6 );
+    buffer->triangle_count = 2;
+    buffer->topology_hash = 0x1234;
+    buffer->bounds.setExtents( Ogre::Vector3( 0, 0, 0 ), Ogre::Vector3( 1, 1, 0 ));
+
+    buffer->chunks.resize( 2 );
+    for( size_t c = 0; c < 2; c++ )
+    {
+      buffer->chunks[c].index_start = c * 3;
+      buffer->chunks[c].index_count = 3;
+      buffer->chunks[c].bounds = buffer->bounds;
+    }
+
+    buffer->lod_indices.push_back( std::vector<uint32_t>( indices, indices + 3 ));
+    buffer->lod_chunk_ranges.resize( 1 );
+    buffer->lod_chunk_ranges[0].push_back( std::make_pair( (size_t)0, (size_t)3 ));
+    buffer->lod_chunk_ranges[0].push_back( std::make_pair( (size_t)3, (size_t)0 ));
+    return buffer;
+  }
+
+  bool write( const MeshBufferPtr& buffer )
+  {
+    std::map<std::string, MeshBufferConstPtr> buffers;
+    std::map<std::string, uint64_t> fingerprints;
+    buffers["block"] = buffer;
+    fingerprints["block"] = 42;
+    return writeMeshSnapshot( path_, buffers, fingerprints );
+  }
+
+  bool read( std::map<std::string, MeshBufferPtr>& buffers, std::map<std::string, uint64_t>& fingerprints )
+  {
+    return readMeshSnapshot( path_, buffers, fingerprints );
+  }
+
+  std::string readBytes()
+  {
+    std::string data;
+    FILE* file = fopen( path_.c_str(), "rb" );
+    char chunk[4096];
+    size_t size;
+    while( file != NULL && ( size = fread( chunk, 1, sizeof(chunk), file )) > 0 )
+      data.append( chunk, size );
+    if( file != NULL )
+      fclose( file );
+    return data;
+  }
+
+  void writeBytes( const std::string& data )
+  {
+    FILE* file = fopen( path_.c_str(), "wb" );
+    ASSERT_TRUE( file != NULL );
+    size_t written = data.empty() ? 1 : fwrite( data.data(), data.size(), 1, file );
+    fclose( file );
+    ASSERT_EQ( 1u, written );
+  }
+
+  std::string directory_;
+  std::string path_;
+};
+
+} // namespace
+
+TEST_F( MeshSnapshotTest, RoundTrip )
+{
+  MeshBufferPtr buffer = makeBuffer();
+  ASSERT_TRUE( write( buffer ));
+
+  std::map<std::string, MeshBufferPtr> buffers;
+  std::map<std::string, uint64_t> fingerprints;
+  ASSERT_TRUE( read( buffers, fingerprints ));
+  ASSERT_EQ( 1u, buffers.size() );
+  EXPECT_EQ( 42u, fingerprints["block"] );
+
+  const MeshBuffer& restored = *buffers["block"];
+  EXPECT_EQ( buffer->vertices, restored.vertices );
+  EXPECT_EQ( buffer->vertex_count, restored.vertex_count );
+  EXPECT_EQ( buffer->indices, restored.indices );
+  EXPECT_EQ( buffer->triangle_count, restored.triangle_count );
+  EXPECT_EQ( buffer->topology_hash, restored.topology_hash );
+  EXPECT_EQ( buffer->bounds.getMaximum(), restored.bounds.getMaximum() );
+  ASSERT_EQ( 2u, restored.chunks.size() );
+  EXPECT_EQ( 3u, restored.chunks[1].index_start );
+  EXPECT_EQ( 3u, restored.chunks[1].index_count );
+  EXPECT_EQ( buffer->lod_indices, restored.lod_indices );
+  EXPECT_EQ( buffer->lod_chunk_ranges, restored.lod_chunk_ranges );
+}
+
+TEST_F( MeshSnapshotTest, WritesSeparateLevels )
+{
+  // the builder writes levels that aren't attached to the buffer yet
+  MeshBufferPtr buffer = makeBuffer();
+  std::vector<std::vector<uint32_t> > lod_indices;
+  std::vector<std::vector<std::pair<size_t, size_t> > > lod_chunk_ranges;
+  lod_indices.swap( buffer->lod_indices );
+  lod_chunk_ranges.swap( buffer->lod_chunk_ranges );
+  ASSERT_TRUE( writeMeshSnapshot( path_, "block", *buffer, 7, lod_indices, lod_chunk_ranges ));
+
+  std::map<std::string, MeshBufferPtr> buffers;
+  std::map<std::string, uint64_t> fingerprints;
+  ASSERT_TRUE( read( buffers, fingerprints ));
+  EXPECT_EQ( 7u, fingerprints["block"] );
+  EXPECT_EQ( lod_indices, buffers["block"]->lod_indices );
+  EXPECT_EQ( lod_chunk_ranges, buffers["block"]->lod_chunk_ranges );
+}
+
+TEST_F( MeshSnapshotTest, RejectsTruncatedFile )
+{
+  ASSERT_TRUE( write( makeBuffer() ));
+  std::string data = readBytes();
+  ASSERT_FALSE( data.empty() );
+
+  for( size_t size = 0; size < data.size(); size++ )
+  {
+    writeBytes( data.substr( 0, size ));
+    std::map<std::string, MeshBufferPtr> buffers;
+    std::map<std::string, uint64_t> fingerprints;
+    EXPECT_FALSE( read( buffers, fingerprints )) << "size " << size;
+  }
+}
+
+TEST_F( MeshSnapshotTest, RejectsOtherMagic )
+{
+  ASSERT_TRUE( write( makeBuffer() ));
+  std::string data = readBytes();
+  data[0] ^= 1;
+  writeBytes( data );
+
+  std::map<std::string, MeshBufferPtr> buffers;
+  std::map<std::string, uint64_t> fingerprints;
+  EXPECT_FALSE( read( buffers, fingerprints ));
+}
+
+TEST_F( MeshSnapshotTest, RejectsIndicesOutOfRange )
+{
+  MeshBufferPtr buffer = makeBuffer();
+  buffer->indices[4] = 4;
+  ASSERT_TRUE( write( buffer ));
+
+  std::map<std::string, MeshBufferPtr> buffers;
+  std::map<std::string, uint64_t> fingerprints;
+  EXPECT_FALSE( read( buffers, fingerprints ));
+
+  buffer = makeBuffer();
+  buffer->lod_indices[0][1] = 4;
+  ASSERT_TRUE( write( buffer ));
+  EXPECT_FALSE( read( buffers, fingerprints ));
+
+  buffer = makeBuffer();
+  buffer->chunks[1].index_count = 4;
+  ASSERT_TRUE( write( buffer ));
+  EXPECT_FALSE( read( buffers, fingerprints ));
+}
+
+TEST_F( MeshSnapshotTest, RejectsBadLevelRanges )
+{
+  std::map<std::string, MeshBufferPtr> buffers;
+  std::map<std::string, uint64_t> fingerprints;
+
+  // a range past the end of its level
+  MeshBufferPtr buffer = makeBuffer();
+  buffer->lod_chunk_ranges[0][1] = std::make_pair( (size_t)2, (size_t)2 );
+  ASSERT_TRUE( write( buffer ));
+  EXPECT_FALSE( read( buffers, fingerprints ));
+
+  // fewer ranges than chunks
+  buffer = makeBuffer();
+  buffer->lod_chunk_ranges[0].pop_back();
+  ASSERT_TRUE( write( buffer ));
+  EXPECT_FALSE( read( buffers, fingerprints ));
+
+  // a level without ranges next to one with them
+  buffer = makeBuffer();
+  buffer->lod_indices.push_back( buffer->lod_indices[0] );
+  ASSERT_TRUE( write( buffer ));
+  EXPECT_FALSE( read( buffers, fingerprints ));
+}
+
+TEST_F( MeshSnapshotTest, MissingFile )
+{
+  std::map<std::string, MeshBufferPtr> buffers;
+  std::map<std::string, uint64_t> fingerprints;
+  EXPECT_FALSE( read( buffers, fingerprints ));
+}
+
+int main( int argc, char** argv )
+{
+  testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}